@@ -0,0 +1,128 @@
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+#include "PathGenerator.h"
+
+#include <algorithm>
+
+namespace {
+
+uint32_t AddVertex(IndexedPath& path, double x, double y) {
+  path.vertices.push_back({ x, y });
+  return static_cast<uint32_t>(path.vertices.size() - 1);
+}
+
+Vector2 Polar(const Vector2& center, double radius, double theta) {
+  return { center.x + radius * cos(theta), center.y + radius * sin(theta) };
+}
+
+IndexedPath GenerateNGon(size_t edgeCount) {
+  IndexedPath path;
+  const size_t sides = std::max<size_t>(3, edgeCount);
+  const double radius = 10;
+
+  for(size_t i = 0; i < sides; ++i) {
+    const auto p = Polar({ 0, 0 }, radius, 2 * M_PI * i / sides);
+    AddVertex(path, p.x, p.y);
+  }
+  for(size_t i = 0; i < sides; ++i)
+    path.lines.push_back({ uint32_t(i), uint32_t((i + 1) % sides) });
+
+  return path;
+}
+
+IndexedPath GenerateGear(size_t edgeCount) {
+  IndexedPath path;
+  const size_t teeth = std::max<size_t>(3, edgeCount / 4);
+  const double tipRadius = 10, rootRadius = 9;
+  const Vector2 center = { 0, 0 };
+  const double span = 2 * M_PI / teeth;
+
+  //Per tooth: tip arc, line down, root arc, line back up to the next tip.
+  for(size_t i = 0; i < teeth; ++i) {
+    const double start = span * i;
+    const auto tip0 = Polar(center, tipRadius, start);
+    const auto tip1 = Polar(center, tipRadius, start + span / 2);
+    const auto root0 = Polar(center, rootRadius, start + span / 2);
+    const auto root1 = Polar(center, rootRadius, start + span);
+    AddVertex(path, tip0.x, tip0.y);
+    AddVertex(path, tip1.x, tip1.y);
+    AddVertex(path, root0.x, root0.y);
+    AddVertex(path, root1.x, root1.y);
+  }
+
+  const uint32_t vertexCount = static_cast<uint32_t>(path.vertices.size());
+  for(uint32_t i = 0; i < vertexCount; i += 4) {
+    path.arcs.push_back({ i, i + 1, center });
+    path.lines.push_back({ i + 1, i + 2 });
+    path.arcs.push_back({ i + 2, i + 3, center });
+    path.lines.push_back({ i + 3, (i + 4) % vertexCount });
+  }
+
+  return path;
+}
+
+IndexedPath GenerateContours(size_t edgeCount) {
+  IndexedPath path;
+  const size_t contours = std::max<size_t>(1, edgeCount / 4);
+  const size_t columns = static_cast<size_t>(ceil(sqrt(double(contours))));
+  const double pitch = 3, size = 2;
+
+  for(size_t i = 0; i < contours; ++i) {
+    const double x = pitch * (i % columns);
+    const double y = pitch * (i / columns);
+
+    if(i % 2 == 0) {
+      const uint32_t v = AddVertex(path, x, y);
+      AddVertex(path, x + size, y);
+      AddVertex(path, x + size, y + size);
+      AddVertex(path, x, y + size);
+      for(uint32_t k = 0; k < 4; ++k)
+        path.lines.push_back({ v + k, v + (k + 1) % 4 });
+    }
+    else {
+      const Vector2 center = { x + size / 2, y + size / 2 };
+      uint32_t v = 0;
+      for(int k = 0; k < 4; ++k) {
+        const auto p = Polar(center, size / 2, M_PI_2 * k);
+        const uint32_t added = AddVertex(path, p.x, p.y);
+        if(k == 0)
+          v = added;
+      }
+      for(uint32_t k = 0; k < 4; ++k)
+        path.arcs.push_back({ v + k, v + (k + 1) % 4, center });
+    }
+  }
+
+  return path;
+}
+
+}
+
+IndexedPath GeneratePath(PathShape shape, size_t edgeCount) {
+  switch(shape) {
+    case PathShape::NGon: return GenerateNGon(edgeCount);
+    case PathShape::Gear: return GenerateGear(edgeCount);
+    case PathShape::Contours: return GenerateContours(edgeCount);
+  }
+  return IndexedPath();
+}
+
+const char* PathShapeName(PathShape shape) {
+  switch(shape) {
+    case PathShape::NGon: return "ngon";
+    case PathShape::Gear: return "gear";
+    case PathShape::Contours: return "contours";
+  }
+  return "unknown";
+}
+
+bool ParsePathShape(const std::string& name, PathShape& shape) {
+  for(auto candidate : { PathShape::NGon, PathShape::Gear, PathShape::Contours }) {
+    if(name == PathShapeName(candidate)) {
+      shape = candidate;
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "IndexedPath.h"
+#include <cstddef>
+#include <string>
+
+//Synthetic path documents for benchmarking. Each generator produces about
+//edgeCount edges, rounded to whole shapes.
+enum class PathShape {
+  NGon,     //One regular polygon of line segments
+  Gear,     //One gear outline, half arcs (tips and roots) and half radial lines
+  Contours  //A grid of disjoint squares and four-arc circles
+};
+
+IndexedPath GeneratePath(PathShape shape, size_t edgeCount);
+
+const char* PathShapeName(PathShape shape);
+bool ParsePathShape(const std::string& name, PathShape& shape);
@@ -0,0 +1,409 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AllocationCounter.h"
+#include "EditablePath.h"
+#include "GeometryKernels.h"
+#include "JsonSerialization.h"
+#include "MotionPlanner.h"
+#include "Nesting.h"
+#include "OrientedBounds.h"
+#include "PathGenerator.h"
+#include "PathLoader.h"
+#include "PathTopology.h"
+#include "PathValidation.h"
+#include "Profile.h"
+#include "RapidSequencing.h"
+#include "ThreadPool.h"
+#include "ToolPath.h"
+#include "picojson.h"
+
+//Benchmarks each stage of quoting a synthetic path and prints one json
+//object per (shape, size) case, one per line.
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+struct BenchOptions {
+  std::vector<PathShape> shapes;
+  std::vector<size_t> sizes;
+  int repeat;
+  unsigned threads;
+  std::string emit; //write the generated json here instead of benchmarking
+  std::vector<size_t> nestSizes; //part counts to nest instead of benchmarking paths
+};
+
+void PrintUsage() {
+  std::cout << "Usage: cadquote_bench [--shape ngon|gear|contours]... [--edges N]... [--repeat R] [-j N]" << std::endl;
+  std::cout << "       cadquote_bench --shape <shape> --edges N --emit <out.json>" << std::endl;
+  std::cout << "       cadquote_bench --nest N... [--repeat R]" << std::endl;
+}
+
+double Seconds(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+//Best of repeat runs, since the geometry queries are short enough to be noisy.
+template<typename Fn>
+double BestOf(int repeat, Fn fn) {
+  double best = 0;
+  for(int i = 0; i < repeat; ++i) {
+    const auto start = Clock::now();
+    fn();
+    const double elapsed = Seconds(start);
+    if(i == 0 || elapsed < best)
+      best = elapsed;
+  }
+  return best;
+}
+
+//Heap allocations made by a single call of fn.
+template<typename Fn>
+uint64_t CountAllocations(Fn fn) {
+  const auto before = AllocationCount();
+  fn();
+  return AllocationCount() - before;
+}
+
+void WriteStage(std::ostream& out, const char* name, double seconds, size_t edges) {
+  out << ",\"" << name << "_s\":" << seconds
+      << ",\"" << name << "_edges_per_s\":" << (seconds > 0 ? edges / seconds : 0);
+}
+
+void WriteAllocations(std::ostream& out, const char* name, uint64_t allocations) {
+  out << ",\"" << name << "_allocs\":" << allocations;
+}
+
+//Evaluates the path in one chunk per pool thread, the way a caller with a
+//very large part would.
+PathMetrics EvaluateParallel(const ToolPath& path, ThreadPool& pool) {
+  const auto ranges = path.Partition(pool.ThreadCount());
+  std::vector<PathMetrics> chunks(ranges.size());
+  for(size_t i = 0; i < ranges.size(); ++i)
+    pool.Submit([&, i] { chunks[i] = path.Evaluate(ranges[i]); });
+  pool.Wait();
+
+  PathMetrics metrics = chunks[0];
+  for(size_t i = 1; i < chunks.size(); ++i)
+    metrics = MergeMetrics(metrics, chunks[i]);
+  return metrics;
+}
+
+bool SameIndexedPath(const IndexedPath& a, const IndexedPath& b) {
+  const auto sameVertex = [](const Vector2& p, const Vector2& q) { return p.x == q.x && p.y == q.y; };
+  const auto sameLine = [](const IndexedPath::Line& p, const IndexedPath::Line& q) { return p.v0 == q.v0 && p.v1 == q.v1; };
+  const auto sameArc = [&](const IndexedPath::Arc& p, const IndexedPath::Arc& q) {
+    return p.v0 == q.v0 && p.v1 == q.v1 && sameVertex(p.center, q.center);
+  };
+  return a.vertices.size() == b.vertices.size() && a.lines.size() == b.lines.size() && a.arcs.size() == b.arcs.size() &&
+    std::equal(a.vertices.begin(), a.vertices.end(), b.vertices.begin(), sameVertex) &&
+    std::equal(a.lines.begin(), a.lines.end(), b.lines.begin(), sameLine) &&
+    std::equal(a.arcs.begin(), a.arcs.end(), b.arcs.begin(), sameArc);
+}
+
+void RunCase(PathShape shape, size_t requestedEdges, int repeat, ThreadPool& pool) {
+  std::string json;
+  {
+    std::ostringstream out;
+    WritePathJson(GeneratePath(shape, requestedEdges), out);
+    json = out.str();
+  }
+
+  //The picojson DOM route the loader replaced, as a baseline. The DOM is
+  //torn down inside the measured call.
+  const auto domParse = [&] {
+    picojson::value document;
+    picojson::parse(document, json);
+    ToolPath fromDom(document);
+  };
+  const double domParseTime = BestOf(repeat, domParse);
+  const uint64_t domParseAllocs = CountAllocations(domParse);
+
+  IndexedPath indexed;
+  const auto parse = [&] { indexed = LoadIndexedPath(json.data(), json.size()); };
+  const double parseTime = BestOf(repeat, parse);
+  const uint64_t parseAllocs = CountAllocations(parse);
+  const size_t edges = indexed.lines.size() + indexed.arcs.size();
+
+  //A long lived loader, as used by --serve, after it has warmed up.
+  PathLoader loader;
+  IndexedPath reused;
+  const auto parseReused = [&] { loader.Load(json.data(), json.size(), reused); };
+  parseReused();
+  const uint64_t parseReusedAllocs = CountAllocations(parseReused);
+
+  //Documents under the loader's size threshold take the serial path here.
+  IndexedPath parallel;
+  const double parseParallelTime = BestOf(repeat, [&] { loader.LoadParallel(json.data(), json.size(), parallel, pool); });
+  if(!SameIndexedPath(parallel, indexed)) {
+    std::cerr << "Parallel parse of " << PathShapeName(shape) << " differs from the serial parse" << std::endl;
+    exit(1);
+  }
+
+  PathTopology topology;
+  const double topologyTime = BestOf(repeat, [&] { topology = AnalyzeTopology(indexed); });
+
+  //Planned once, with a second of improvement on top of the visit budget
+  //so the largest cases don't dominate the run.
+  auto rapidOptions = DefaultRapidOptions();
+  rapidOptions.timeBudget = 1.0;
+  const auto rapidsStart = Clock::now();
+  const auto rapids = PlanRapidMoves(indexed, topology, rapidOptions);
+  const double rapidsTime = Seconds(rapidsStart);
+  std::vector<uint32_t> sorted = rapids.order;
+  std::sort(sorted.begin(), sorted.end());
+  for(size_t i = 0; i < sorted.size(); ++i) {
+    if(sorted[i] != i) {
+      std::cerr << "Rapid plan for " << PathShapeName(shape) << " does not visit every contour once" << std::endl;
+      exit(1);
+    }
+  }
+
+  //Kinematic timing on a laser-like machine. It can never beat cutting the
+  //whole sequence at full speed.
+  CutSequence cuts;
+  const double sequenceTime = BestOf(repeat, [&] { MakeCutSequence(indexed, topology, rapids, cuts); });
+  double kinematicSeconds = 0;
+  const double kinematicTime = BestOf(repeat, [&] { kinematicSeconds = ComputeKinematicTime(cuts, 0.5, 20, 0.002); });
+  double cutLength = 0;
+  for(double length : cuts.length)
+    cutLength += length;
+  if(!(kinematicSeconds >= cutLength / 0.5 * (1 - 1e-12))) {
+    std::cerr << "Kinematic time for " << PathShapeName(shape) << " is under the full speed bound" << std::endl;
+    exit(1);
+  }
+
+  //The oriented box must hold every vertex.
+  OrientedBox box{};
+  const double orientedTime = BestOf(repeat, [&] { box = ComputeOrientedBounds(indexed); });
+  const Vector2 across = { -box.axis.y, box.axis.x };
+  for(const auto& vertex : indexed.vertices) {
+    const double u = Dot(vertex - box.corner, box.axis);
+    const double v = Dot(vertex - box.corner, across);
+    const double slack = 1e-9 * (1 + box.size.x + box.size.y);
+    if(u < -slack || v < -slack || u > box.size.x + slack || v > box.size.y + slack) {
+      std::cerr << "Oriented box for " << PathShapeName(shape) << " misses a vertex" << std::endl;
+      exit(1);
+    }
+  }
+
+  //The synthetic shapes are well formed, so validation must pass them.
+  std::vector<uint32_t> intersecting;
+  const double validateTime = BestOf(repeat, [&] { intersecting = FindIntersectingEdges(indexed, nullptr); });
+  const double validateParallelTime = BestOf(repeat, [&] { intersecting = FindIntersectingEdges(indexed, &pool); });
+  if(!intersecting.empty()) {
+    std::cerr << "Validation reports " << intersecting.size() << " intersecting edges in " << PathShapeName(shape) << std::endl;
+    exit(1);
+  }
+
+  ToolPath path;
+  const double constructTime = BestOf(repeat, [&] { path = MakeToolPath(indexed); });
+  const uint64_t constructAllocs = CountAllocations([&] { path = MakeToolPath(indexed); });
+
+  //The same with the approximate arc trig, which must stay within 1e-12 of
+  //the libm metrics the quote is computed from.
+  ToolPath fastPath;
+  SetFastArcMath(true);
+  const double constructFastTime = BestOf(repeat, [&] { fastPath = MakeToolPath(indexed); });
+  SetFastArcMath(false);
+  const auto exact = path.Evaluate();
+  const auto fast = fastPath.Evaluate();
+  const auto relativeError = [](double approximate, double reference) {
+    return std::abs(approximate - reference) / std::max(std::abs(reference), 1e-300);
+  };
+  const double fastError = std::max(relativeError(fast.travel, exact.travel),
+                                    std::max(relativeError(fast.Bounds().x, exact.Bounds().x),
+                                             relativeError(fast.Bounds().y, exact.Bounds().y)));
+  if(!(fastError <= 1e-12)) {
+    std::cerr << "Fast arc math moves the " << PathShapeName(shape) << " metrics by " << fastError << std::endl;
+    exit(1);
+  }
+
+  volatile double sink = 0;
+  const double travelTime = BestOf(repeat, [&] { sink = path.ComputeTravelHeuristic(); });
+  const double boundsTime = BestOf(repeat, [&] { sink = path.ComputeBounds().x; });
+  const double evaluateTime = BestOf(repeat, [&] { sink = path.Evaluate().travel; });
+  const double parallelTime = BestOf(repeat, [&] { sink = EvaluateParallel(path, pool).travel; });
+
+  //Interactive editing: nudge random vertices, reading the totals back
+  //after each move, then check them against evaluating the result afresh.
+  EditablePath editable(indexed);
+  const size_t editCount = 10000;
+  std::mt19937 random(11);
+  std::uniform_int_distribution<uint32_t> pickVertex(0, static_cast<uint32_t>(indexed.vertices.size() - 1));
+  std::uniform_real_distribution<double> nudge(-0.01, 0.01);
+  const auto editStart = Clock::now();
+  for(size_t i = 0; i < editCount; ++i) {
+    const uint32_t vertex = pickVertex(random);
+    const auto position = editable.Position(vertex);
+    editable.MoveVertex(vertex, { position.x + nudge(random), position.y + nudge(random) });
+    sink = editable.Travel() + editable.Bounds().x;
+  }
+  const double editTime = Seconds(editStart) / editCount;
+  (void)sink;
+
+  const auto edited = MakeToolPath(editable.ToIndexedPath()).Evaluate();
+  const auto editedBounds = editable.Bounds();
+  if(std::abs(edited.travel - editable.Travel()) > 1e-9 * edited.travel ||
+     edited.Bounds().x != editedBounds.x || edited.Bounds().y != editedBounds.y) {
+    std::cerr << "Edited " << PathShapeName(shape) << " metrics differ from a fresh evaluation" << std::endl;
+    exit(1);
+  }
+
+  std::cout << "{\"shape\":\"" << PathShapeName(shape) << "\""
+            << ",\"edges\":" << edges
+            << ",\"lines\":" << indexed.lines.size()
+            << ",\"arcs\":" << indexed.arcs.size()
+            << ",\"json_bytes\":" << json.size()
+            << ",\"kernels\":\"" << GeometryKernelName() << "\""
+            << ",\"components\":" << topology.componentCount
+            << ",\"contours\":" << topology.ContourCount()
+            << ",\"open_chains\":" << topology.OpenChainCount()
+            << ",\"rapid_nn\":" << rapids.nearestNeighbourDistance
+            << ",\"rapid\":" << rapids.rapidDistance
+            << ",\"fast_math_error\":" << fastError
+            << ",\"kinematic_time\":" << kinematicSeconds
+            << ",\"oriented_area\":" << box.size.x * box.size.y;
+  WriteStage(std::cout, "dom_parse", domParseTime, edges);
+  WriteStage(std::cout, "parse", parseTime, edges);
+  WriteStage(std::cout, "parse_parallel", parseParallelTime, edges);
+  WriteStage(std::cout, "topology", topologyTime, edges);
+  WriteStage(std::cout, "rapids", rapidsTime, edges);
+  WriteStage(std::cout, "cut_sequence", sequenceTime, edges);
+  WriteStage(std::cout, "kinematic", kinematicTime, edges);
+  WriteStage(std::cout, "oriented_bounds", orientedTime, edges);
+  WriteStage(std::cout, "validate", validateTime, edges);
+  WriteStage(std::cout, "validate_parallel", validateParallelTime, edges);
+  WriteStage(std::cout, "construct", constructTime, edges);
+  WriteStage(std::cout, "construct_fast", constructFastTime, edges);
+  WriteStage(std::cout, "travel", travelTime, edges);
+  WriteStage(std::cout, "bounds", boundsTime, edges);
+  WriteStage(std::cout, "evaluate", evaluateTime, edges);
+  WriteStage(std::cout, "evaluate_parallel", parallelTime, edges);
+  std::cout << ",\"edit_vertex_s\":" << editTime;
+  WriteAllocations(std::cout, "dom_parse", domParseAllocs);
+  WriteAllocations(std::cout, "parse", parseAllocs);
+  WriteAllocations(std::cout, "parse_reused", parseReusedAllocs);
+  WriteAllocations(std::cout, "construct", constructAllocs);
+  std::cout << ",\"peak_rss_kb\":" << PeakRssKb() << "}" << std::endl;
+}
+
+//Nests count random parts, from washers to brackets, on 48x96 sheets.
+void RunNestCase(size_t count, int repeat) {
+  std::mt19937 random(7);
+  std::uniform_real_distribution<double> side(0.5, 12.0);
+  std::vector<Vector2> parts(count);
+  for(auto& part : parts)
+    part = { side(random), side(random) };
+
+  const NestOptions options = { { 48, 96 }, true };
+  NestResult nest;
+  const double nestTime = BestOf(repeat, [&] { nest = NestParts(parts, options); });
+
+  //Placed parts must stay on their sheet and never overlap.
+  std::vector<std::vector<size_t>> bySheet(nest.sheetCount);
+  for(size_t i = 0; i < count; ++i)
+    bySheet[nest.placements[i].sheet].push_back(i);
+  const auto placedSize = [&](size_t i) {
+    return nest.placements[i].rotated ? Vector2{ parts[i].y, parts[i].x } : parts[i];
+  };
+  for(const auto& sheet : bySheet) {
+    for(size_t a = 0; a < sheet.size(); ++a) {
+      const auto p = nest.placements[sheet[a]].position;
+      const auto s = placedSize(sheet[a]);
+      bool valid = p.x >= 0 && p.y >= 0 && p.x + s.x <= options.sheet.x && p.y + s.y <= options.sheet.y;
+      for(size_t b = a + 1; b < sheet.size() && valid; ++b) {
+        const auto q = nest.placements[sheet[b]].position;
+        const auto t = placedSize(sheet[b]);
+        valid = p.x + s.x <= q.x || q.x + t.x <= p.x || p.y + s.y <= q.y || q.y + t.y <= p.y;
+      }
+      if(!valid) {
+        std::cerr << "Nested part " << sheet[a] << " overlaps or leaves its sheet" << std::endl;
+        exit(1);
+      }
+    }
+  }
+
+  std::cout << "{\"nest_parts\":" << count
+            << ",\"sheets\":" << nest.sheetCount
+            << ",\"utilization\":" << nest.Utilization(options.sheet)
+            << ",\"nest_s\":" << nestTime
+            << ",\"parts_per_s\":" << (nestTime > 0 ? count / nestTime : 0) << "}" << std::endl;
+}
+
+}
+
+int main(int argc, char** argv) {
+  BenchOptions options;
+  options.repeat = 3;
+  options.threads = std::thread::hardware_concurrency();
+
+  for(int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+
+    PathShape shape;
+    if(arg == "--shape" && hasValue && ParsePathShape(argv[i+1], shape)) {
+      options.shapes.push_back(shape);
+      ++i;
+    }
+    else if(arg == "--edges" && hasValue) {
+      //strtod so sizes can be written as 1e6
+      options.sizes.push_back(static_cast<size_t>(strtod(argv[++i], nullptr)));
+    }
+    else if(arg == "--repeat" && hasValue) {
+      options.repeat = std::max(1, atoi(argv[++i]));
+    }
+    else if(arg == "-j" && hasValue) {
+      options.threads = std::max(1, atoi(argv[++i]));
+    }
+    else if(arg == "--nest" && hasValue) {
+      options.nestSizes.push_back(static_cast<size_t>(strtod(argv[++i], nullptr)));
+    }
+    else if(arg == "--emit" && hasValue) {
+      options.emit = argv[++i];
+    }
+    else {
+      PrintUsage();
+      return 1;
+    }
+  }
+
+  if(!options.nestSizes.empty()) {
+    for(const auto count : options.nestSizes)
+      RunNestCase(count, options.repeat);
+    return 0;
+  }
+
+  if(options.shapes.empty())
+    options.shapes = { PathShape::NGon, PathShape::Gear, PathShape::Contours };
+  if(options.sizes.empty())
+    options.sizes = { 1000, 10000, 100000, 1000000 };
+
+  if(!options.emit.empty()) {
+    if(options.shapes.size() != 1 || options.sizes.size() != 1) {
+      PrintUsage();
+      return 1;
+    }
+    std::ofstream out(options.emit);
+    WritePathJson(GeneratePath(options.shapes[0], options.sizes[0]), out);
+    return out ? 0 : 1;
+  }
+
+  ThreadPool pool(options.threads);
+  for(const auto shape : options.shapes) {
+    for(const auto size : options.sizes)
+      RunCase(shape, size, options.repeat, pool);
+  }
+  return 0;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <cstdint>
+
+//Number of global operator new calls made by the process so far.
+//Counting is done by replacing the global allocation functions, so it
+//covers every container and string in the program. It is built as its own
+//library, cadalloc, linked into the bench and into CADQUOTE_PROFILE builds.
+uint64_t AllocationCount();
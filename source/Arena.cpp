@@ -0,0 +1,38 @@
+#include "Arena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+MonotonicArena::MonotonicArena(size_t firstBlockSize)
+  : m_current(0), m_offset(0), m_nextBlockSize(firstBlockSize) {}
+
+MonotonicArena::~MonotonicArena() {
+  for(const auto& block : m_blocks)
+    ::operator delete(block.data);
+}
+
+void* MonotonicArena::Allocate(size_t size, size_t alignment) {
+  //Blocks kept from before the last Reset are reused in order before new ones are added.
+  for(; m_current < m_blocks.size(); ++m_current, m_offset = 0) {
+    const auto& block = m_blocks[m_current];
+    const auto address = reinterpret_cast<uintptr_t>(block.data) + m_offset;
+    const size_t padding = (alignment - address % alignment) % alignment;
+    if(m_offset + padding + size <= block.size) {
+      m_offset += padding + size;
+      return block.data + m_offset - size;
+    }
+  }
+
+  //operator new returns memory aligned for any fundamental type.
+  const size_t blockSize = std::max(m_nextBlockSize, size);
+  m_blocks.push_back({ static_cast<char*>(::operator new(blockSize)), blockSize });
+  m_nextBlockSize = blockSize * 2;
+  m_current = m_blocks.size() - 1;
+  m_offset = size;
+  return m_blocks.back().data;
+}
+
+void MonotonicArena::Reset() {
+  m_current = 0;
+  m_offset = 0;
+}
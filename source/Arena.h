@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+//Bump allocator for data that lives exactly as long as one parse.
+//Individual frees are no-ops; Reset() releases everything at once but keeps
+//the blocks, so an arena reused across documents stops touching the heap
+//once it has seen its largest one.
+class MonotonicArena {
+public:
+  explicit MonotonicArena(size_t firstBlockSize = 64 * 1024);
+  ~MonotonicArena();
+
+  MonotonicArena(const MonotonicArena&) = delete;
+  MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+  void* Allocate(size_t size, size_t alignment);
+  void Reset();
+
+  size_t BlockCount() const { return m_blocks.size(); }
+
+private:
+  struct Block {
+    char* data;
+    size_t size;
+  };
+
+  std::vector<Block> m_blocks;
+  size_t m_current; //Block being bumped
+  size_t m_offset; //Into the current block
+  size_t m_nextBlockSize;
+};
+
+//Standard allocator over a MonotonicArena, for containers whose contents
+//are thrown away in bulk with the arena.
+template<typename T>
+class ArenaAllocator {
+public:
+  typedef T value_type;
+
+  ArenaAllocator(MonotonicArena& arena) : m_arena(&arena) {}
+  template<typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other) : m_arena(other.Arena()) {}
+
+  T* allocate(size_t count) {
+    return static_cast<T*>(m_arena->Allocate(count * sizeof(T), alignof(T)));
+  }
+  void deallocate(T*, size_t) {}
+
+  MonotonicArena* Arena() const { return m_arena; }
+
+private:
+  MonotonicArena* m_arena;
+};
+
+template<typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.Arena() == b.Arena(); }
+template<typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.Arena() != b.Arena(); }
@@ -0,0 +1,290 @@
+#include "Batch.h"
+#include "MachineInfo.h"
+#include "Nesting.h"
+#include "Quote.h"
+#include "ThreadPool.h"
+#include "ToolingCatalog.h"
+#include "picojson.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+namespace {
+
+struct BatchItem {
+  std::string path;
+  off_t size;
+};
+
+bool IsDirectory(const std::string& path) {
+  struct stat info;
+  return stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+}
+
+off_t FileSize(const std::string& path) {
+  struct stat info;
+  return stat(path.c_str(), &info) == 0 ? info.st_size : 0;
+}
+
+bool HasJsonExtension(const std::string& name) {
+  const std::string ext = ".json";
+  return name.size() > ext.size() && name.compare(name.size() - ext.size(), ext.size(), ext) == 0;
+}
+
+std::vector<BatchItem> CollectItems(const std::string& source) {
+  std::vector<std::string> paths;
+
+  if(IsDirectory(source)) {
+    DIR* dir = opendir(source.c_str());
+    if(!dir)
+      throw std::runtime_error("Error opening batch directory " + source);
+
+    while(const dirent* entry = readdir(dir)) {
+      const std::string name = entry->d_name;
+      if(HasJsonExtension(name))
+        paths.push_back(source + "/" + name);
+    }
+    closedir(dir);
+  }
+  else {
+    std::ifstream list(source);
+    if(!list)
+      throw std::runtime_error("Error opening batch list " + source);
+
+    std::string line;
+    while(std::getline(list, line)) {
+      if(!line.empty() && line.back() == '\r')
+        line.pop_back();
+      if(!line.empty())
+        paths.push_back(line);
+    }
+  }
+
+  std::vector<BatchItem> items;
+  items.reserve(paths.size());
+  for(auto& path : paths) {
+    const auto size = FileSize(path);
+    items.push_back({ std::move(path), size });
+  }
+
+  //Largest first, so a huge part picked up last can't hold up the tail of the run.
+  std::stable_sort(items.begin(), items.end(),
+    [](const BatchItem& a, const BatchItem& b) { return a.size > b.size; });
+  return items;
+}
+
+std::string CsvField(const std::string& text) {
+  if(text.find_first_of(",\"\n") == std::string::npos)
+    return text;
+
+  std::string quoted = "\"";
+  for(char c : text) {
+    if(c == '"')
+      quoted += '"';
+    quoted += c;
+  }
+  return quoted + "\"";
+}
+
+//The cut_time_s,cost columns.
+std::string CsvQuoteFields(const Quote& quote) {
+  std::ostringstream fields;
+  fields << quote.cutTime << ',' << std::fixed << std::setprecision(2) << quote.cost;
+  return fields.str();
+}
+
+std::string FormatResult(BatchFormat format, const std::string& path, const Quote* quote, const std::string& error) {
+  std::ostringstream line;
+
+  if(format == BatchFormat::Csv) {
+    line << CsvField(path) << ',';
+    if(quote)
+      line << CsvQuoteFields(*quote) << ',';
+    else
+      line << ",," << CsvField(error);
+  }
+  else {
+    line << "{\"path\":" << picojson::value(path).serialize();
+    if(quote)
+      line << ',' << QuoteJsonFields(*quote);
+    else
+      line << ",\"error\":" << picojson::value(error).serialize();
+    line << '}';
+  }
+
+  return line.str();
+}
+
+//A part's quote table, as one line per machine for csv. A failed part gets
+//a single line with an empty machine.
+std::string FormatTable(BatchFormat format, const std::string& path, const ToolingCatalog& catalog,
+                        const std::vector<Quote>* quotes, const std::string& error) {
+  std::ostringstream lines;
+
+  if(format == BatchFormat::Csv) {
+    if(!quotes) {
+      lines << CsvField(path) << ",,,," << CsvField(error);
+      return lines.str();
+    }
+    for(size_t i = 0; i < quotes->size(); ++i) {
+      lines << (i == 0 ? "" : "\n") << CsvField(path) << ',' << CsvField(catalog.names[i]) << ','
+            << CsvQuoteFields((*quotes)[i]) << ',';
+    }
+  }
+  else {
+    lines << "{\"path\":" << picojson::value(path).serialize();
+    if(quotes)
+      lines << ",\"quotes\":" << QuoteTableJson(catalog, *quotes);
+    else
+      lines << ",\"error\":" << picojson::value(error).serialize();
+    lines << '}';
+  }
+
+  return lines.str();
+}
+
+//Nested results need every part's bounds first, so nothing is written
+//until the whole job has loaded.
+size_t RunNestedBatch(const MachineInfo& tooling, const BatchOptions& options,
+                      const std::vector<BatchItem>& items, std::ostream& out, std::ostream& summary) {
+  struct PartResult {
+    PathEvaluation evaluation;
+    std::string error;
+  };
+  std::vector<PartResult> results(items.size());
+
+  ThreadPool pool(options.threads);
+  for(size_t i = 0; i < items.size(); ++i) {
+    pool.Submit([&, i] {
+      try {
+        //Buffers without a pool: this is already one of the pool's threads.
+        thread_local QuoteBuffers buffers;
+        results[i].evaluation = EvaluateFile(tooling, items[i].path, buffers);
+      }
+      catch(const std::exception& e) {
+        results[i].error = e.what();
+      }
+    });
+  }
+  pool.Wait();
+
+  //Parts are nested by padded bounds, the same box ComputeCost charges,
+  //turned to the oriented box where that is smaller.
+  std::vector<Vector2> parts;
+  for(size_t i = 0; i < results.size(); ++i) {
+    if(!results[i].error.empty())
+      continue;
+    const auto bounds = ChargedBounds(tooling, results[i].evaluation.metrics.Bounds(), results[i].evaluation.orientedBounds);
+    const Vector2 part = { bounds.x + tooling.padding, bounds.y + tooling.padding };
+    if(!FitsOnSheet(part, *options.nest)) {
+      results[i].error = "Part does not fit on the stock sheet";
+      continue;
+    }
+    parts.push_back(part);
+  }
+  const auto nest = NestParts(parts, *options.nest);
+  const double areaScale = nest.partArea > 0 ? nest.ChargedArea(options.nest->sheet) / nest.partArea : 0;
+
+  if(options.format == BatchFormat::Csv)
+    out << "path,cut_time_s,cost,sheet,x,y,rotated,error" << std::endl;
+
+  size_t failures = 0;
+  size_t nextPart = 0;
+  double jobCost = 0;
+  for(size_t i = 0; i < items.size(); ++i) {
+    std::ostringstream line;
+    const bool failed = !results[i].error.empty();
+    const bool json = options.format == BatchFormat::JsonLines;
+    if(json)
+      line << "{\"path\":" << picojson::value(items[i].path).serialize();
+    else
+      line << CsvField(items[i].path) << ',';
+
+    if(failed) {
+      ++failures;
+      if(json)
+        line << ",\"error\":" << picojson::value(results[i].error).serialize() << '}';
+      else
+        line << ",,,,,," << CsvField(results[i].error);
+      out << line.str() << std::endl;
+      continue;
+    }
+
+    const auto& placement = nest.placements[nextPart];
+    const auto& part = parts[nextPart++];
+    const double cutTime = results[i].evaluation.cutTime;
+    const Quote quote = { cutTime, ComputeCost(tooling, part.x * part.y * areaScale, cutTime) };
+    jobCost += quote.cost;
+
+    std::ostringstream position;
+    position << placement.position.x << (json ? ",\"y\":" : ",") << placement.position.y;
+    if(json)
+      line << ',' << QuoteJsonFields(quote) << ",\"sheet\":" << placement.sheet
+           << ",\"x\":" << position.str() << ",\"rotated\":" << (placement.rotated ? "true" : "false") << '}';
+    else
+      line << CsvQuoteFields(quote) << ',' << placement.sheet << ',' << position.str() << ','
+           << (placement.rotated ? 1 : 0) << ',';
+    out << line.str() << std::endl;
+  }
+
+  summary << "Nesting: {\"sheets\":" << nest.sheetCount
+          << ",\"parts\":" << parts.size()
+          << ",\"charged_area\":" << nest.ChargedArea(options.nest->sheet)
+          << ",\"utilization\":" << nest.Utilization(options.nest->sheet)
+          << ",\"job_cost\":" << std::fixed << std::setprecision(2) << jobCost << "}" << std::endl;
+  return failures;
+}
+
+}
+
+size_t RunBatch(const MachineInfo& tooling, const BatchOptions& options, std::ostream& out, std::ostream& summary) {
+  const auto items = CollectItems(options.source);
+  if(options.nest)
+    return RunNestedBatch(tooling, options, items, out, summary);
+
+  std::mutex outMutex;
+  std::atomic<size_t> failures(0);
+
+  if(options.format == BatchFormat::Csv)
+    out << (options.catalog ? "path,machine,cut_time_s,cost,error" : "path,cut_time_s,cost,error") << std::endl;
+
+  ThreadPool pool(options.threads);
+  for(const auto& item : items) {
+    pool.Submit([&, item] {
+      std::string line;
+      try {
+        thread_local QuoteBuffers buffers;
+        if(options.catalog) {
+          thread_local std::vector<Quote> quotes;
+          QuoteFile(*options.catalog, item.path, buffers, options.cache, quotes);
+          line = FormatTable(options.format, item.path, *options.catalog, &quotes, std::string());
+        }
+        else {
+          const auto quote = QuoteFile(tooling, item.path, buffers, options.cache);
+          line = FormatResult(options.format, item.path, &quote, std::string());
+        }
+      }
+      catch(const std::exception& e) {
+        ++failures;
+        line = options.catalog ?
+          FormatTable(options.format, item.path, *options.catalog, nullptr, e.what()) :
+          FormatResult(options.format, item.path, nullptr, e.what());
+      }
+
+      std::lock_guard<std::mutex> lock(outMutex);
+      out << line << std::endl;
+    });
+  }
+  pool.Wait();
+
+  return failures;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+
+struct MachineInfo;
+struct ToolingCatalog;
+struct NestOptions;
+class QuoteCache;
+
+enum class BatchFormat { Csv, JsonLines };
+
+struct BatchOptions {
+  std::string source; //A directory of *.json paths, or a file listing one path per line
+  unsigned threads;
+  BatchFormat format;
+  QuoteCache* cache; //Optional
+  const ToolingCatalog* catalog; //Optional; quotes every entry instead of tooling
+  const NestOptions* nest; //Optional; nests all parts onto shared stock sheets
+};
+
+//Quotes every path named by options.source concurrently and writes one
+//result line per part to out as soon as that part finishes, so results
+//arrive in completion order rather than input order. With a catalog each
+//part gets a quote table: one csv row per machine, or a "quotes" array.
+//
+//With nest options the whole job is packed onto stock sheets first (see
+//Nesting.h), so results are written in input order once every part is
+//loaded. Each part is then charged for its share of the sheet area the job
+//used instead of its own bounding box, and the line gives its sheet and
+//position. A job summary goes to summary.
+//Returns the number of parts that failed to quote.
+size_t RunBatch(const MachineInfo& tooling, const BatchOptions& options, std::ostream& out, std::ostream& summary);
@@ -0,0 +1,223 @@
+#include "EditablePath.h"
+#include "ToolPath.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+EditablePath::Summary EditablePath::EmptySummary() {
+  const double inf = std::numeric_limits<double>::infinity();
+  return { 0, inf, inf, -inf, -inf };
+}
+
+EditablePath::Summary EditablePath::Combine(const Summary& a, const Summary& b) {
+  return { a.travel + b.travel,
+           std::min(a.minX, b.minX), std::min(a.minY, b.minY),
+           std::max(a.maxX, b.maxX), std::max(a.maxY, b.maxY) };
+}
+
+EditablePath::EditablePath(const IndexedPath& path) {
+  m_vertices.reserve(path.vertices.size());
+  for(const auto& position : path.vertices)
+    m_vertices.push_back({ position, {}, true });
+  m_vertexCount = m_vertices.size();
+
+  //Edge ids follow PathTopology: lines first, then arcs.
+  m_edges.reserve(path.lines.size() + path.arcs.size());
+  for(const auto& line : path.lines)
+    m_edges.push_back({ line.v0, line.v1, { 0, 0 }, false, true });
+  for(const auto& arc : path.arcs)
+    m_edges.push_back({ arc.v0, arc.v1, arc.center, true, true });
+  m_edgeCount = m_edges.size();
+
+  for(EdgeId e = 0; e < m_edges.size(); ++e) {
+    const auto& edge = m_edges[e];
+    if(edge.v0 >= m_vertices.size() || edge.v1 >= m_vertices.size())
+      throw std::runtime_error("Edge " + std::to_string(e) + " references a vertex outside the path");
+    m_vertices[edge.v0].edges.push_back(e);
+    if(edge.v1 != edge.v0)
+      m_vertices[edge.v1].edges.push_back(e);
+  }
+
+  Reserve(m_edges.size());
+}
+
+EditablePath::Vertex& EditablePath::CheckVertex(VertexId vertex) {
+  if(vertex >= m_vertices.size() || !m_vertices[vertex].alive)
+    throw std::runtime_error("Vertex " + std::to_string(vertex) + " is not in the path");
+  return m_vertices[vertex];
+}
+
+const EditablePath::Vertex& EditablePath::CheckVertex(VertexId vertex) const {
+  return const_cast<EditablePath*>(this)->CheckVertex(vertex);
+}
+
+EditablePath::Edge& EditablePath::CheckEdge(EdgeId edge) {
+  if(edge >= m_edges.size() || !m_edges[edge].alive)
+    throw std::runtime_error("Edge " + std::to_string(edge) + " is not in the path");
+  return m_edges[edge];
+}
+
+EditablePath::VertexId EditablePath::AddVertex(const Vector2& position) {
+  VertexId vertex;
+  if(m_freeVertices.empty()) {
+    vertex = static_cast<VertexId>(m_vertices.size());
+    m_vertices.push_back({ position, {}, true });
+  }
+  else {
+    vertex = m_freeVertices.back();
+    m_freeVertices.pop_back();
+    m_vertices[vertex].position = position;
+    m_vertices[vertex].alive = true;
+  }
+  ++m_vertexCount;
+  return vertex;
+}
+
+void EditablePath::MoveVertex(VertexId vertex, const Vector2& position) {
+  auto& moved = CheckVertex(vertex);
+  moved.position = position;
+  for(const EdgeId edge : moved.edges)
+    Refresh(edge);
+}
+
+void EditablePath::RemoveVertex(VertexId vertex) {
+  //RemoveEdge detaches from this list, so walk a copy.
+  const auto edges = CheckVertex(vertex).edges;
+  for(const EdgeId edge : edges)
+    RemoveEdge(edge);
+
+  m_vertices[vertex].alive = false;
+  m_freeVertices.push_back(vertex);
+  --m_vertexCount;
+}
+
+EditablePath::EdgeId EditablePath::AddLine(VertexId v0, VertexId v1) {
+  CheckVertex(v0);
+  CheckVertex(v1);
+  return AddEdge({ v0, v1, { 0, 0 }, false, true });
+}
+
+EditablePath::EdgeId EditablePath::AddArc(VertexId v0, VertexId v1, const Vector2& center) {
+  CheckVertex(v0);
+  CheckVertex(v1);
+  return AddEdge({ v0, v1, center, true, true });
+}
+
+void EditablePath::MoveArcCenter(EdgeId arc, const Vector2& center) {
+  auto& edge = CheckEdge(arc);
+  if(!edge.arc)
+    throw std::runtime_error("Edge " + std::to_string(arc) + " is not an arc");
+  edge.center = center;
+  Refresh(arc);
+}
+
+void EditablePath::RemoveEdge(EdgeId edge) {
+  auto& removed = CheckEdge(edge);
+  DetachEdge(edge, removed.v0);
+  DetachEdge(edge, removed.v1);
+  removed.alive = false;
+  m_freeEdges.push_back(edge);
+  --m_edgeCount;
+  Refresh(edge);
+}
+
+const Vector2& EditablePath::Position(VertexId vertex) const {
+  return CheckVertex(vertex).position;
+}
+
+EditablePath::EdgeId EditablePath::AddEdge(const Edge& edge) {
+  EdgeId id;
+  if(m_freeEdges.empty()) {
+    id = static_cast<EdgeId>(m_edges.size());
+    m_edges.push_back(edge);
+  }
+  else {
+    id = m_freeEdges.back();
+    m_freeEdges.pop_back();
+    m_edges[id] = edge;
+  }
+  ++m_edgeCount;
+
+  m_vertices[edge.v0].edges.push_back(id);
+  if(edge.v1 != edge.v0)
+    m_vertices[edge.v1].edges.push_back(id);
+
+  //Doubling keeps the rebuilds amortized constant per added edge.
+  if(id >= m_leafCount)
+    Reserve(std::max<size_t>(id + 1, m_leafCount * 2));
+  Refresh(id);
+  return id;
+}
+
+void EditablePath::DetachEdge(EdgeId edge, VertexId vertex) {
+  auto& edges = m_vertices[vertex].edges;
+  edges.erase(std::remove(edges.begin(), edges.end(), edge), edges.end());
+}
+
+EditablePath::Summary EditablePath::Measure(const Edge& edge) const {
+  if(!edge.alive)
+    return EmptySummary();
+
+  const auto& v0 = m_vertices[edge.v0].position;
+  const auto& v1 = m_vertices[edge.v1].position;
+  const auto geometry = edge.arc ? ArcGeometry(v0, v1, edge.center) : LineGeometry(v0, v1);
+  return { geometry.travel, geometry.minPoint.x, geometry.minPoint.y, geometry.maxPoint.x, geometry.maxPoint.y };
+}
+
+void EditablePath::Refresh(EdgeId edge) {
+  size_t node = m_leafCount + edge;
+  m_tree[node] = Measure(m_edges[edge]);
+  for(node /= 2; node > 0; node /= 2)
+    m_tree[node] = Combine(m_tree[2 * node], m_tree[2 * node + 1]);
+}
+
+void EditablePath::Reserve(size_t capacity) {
+  size_t leafCount = 1;
+  while(leafCount < capacity)
+    leafCount *= 2;
+  if(leafCount <= m_leafCount)
+    return;
+
+  m_leafCount = leafCount;
+  m_tree.assign(2 * leafCount, EmptySummary());
+  for(size_t e = 0; e < m_edges.size(); ++e)
+    m_tree[leafCount + e] = Measure(m_edges[e]);
+  for(size_t node = leafCount - 1; node > 0; --node)
+    m_tree[node] = Combine(m_tree[2 * node], m_tree[2 * node + 1]);
+}
+
+double EditablePath::Travel() const {
+  return m_tree.empty() ? 0 : m_tree[1].travel;
+}
+
+Vector2 EditablePath::Bounds() const {
+  if(m_edgeCount == 0)
+    return { 0, 0 };
+  const auto& root = m_tree[1];
+  return { root.maxX - root.minX, root.maxY - root.minY };
+}
+
+IndexedPath EditablePath::ToIndexedPath() const {
+  IndexedPath path;
+  path.vertices.reserve(m_vertexCount);
+
+  std::vector<uint32_t> remap(m_vertices.size(), 0);
+  for(VertexId v = 0; v < m_vertices.size(); ++v) {
+    if(!m_vertices[v].alive)
+      continue;
+    remap[v] = static_cast<uint32_t>(path.vertices.size());
+    path.vertices.push_back(m_vertices[v].position);
+  }
+
+  for(const auto& edge : m_edges) {
+    if(!edge.alive)
+      continue;
+    if(edge.arc)
+      path.arcs.push_back({ remap[edge.v0], remap[edge.v1], edge.center });
+    else
+      path.lines.push_back({ remap[edge.v0], remap[edge.v1] });
+  }
+  return path;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "IndexedPath.h"
+#include "Vector2.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//A path that can be edited in place while its travel heuristic and bounds
+//stay current, for interactive editing where re-quoting after every change
+//must not re-walk the whole path.
+//
+//Edges refer to vertices by id, so moving a vertex moves every edge on it.
+//Each edge's travel and extent sit in a leaf of a segment tree over edge
+//slots; an edit refreshes the leaves it changes and the nodes above them,
+//so adding, removing or reshaping an edge costs O(log n), and moving a
+//vertex O(d log n) for its d edges. Travel and bounds are read from the
+//root in O(1) and agree with ToolPath::Evaluate on the same edges, up to
+//the order of the travel additions.
+//
+//Ids stay valid until the vertex or edge is removed; freed ids are reused.
+//Using an id that is not in the path throws a runtime_error.
+class EditablePath {
+public:
+  typedef uint32_t VertexId;
+  typedef uint32_t EdgeId;
+
+  EditablePath() {}
+
+  //Vertex ids are the indices in path.vertices. Edge ids number lines
+  //first, then arcs, as in PathTopology.
+  explicit EditablePath(const IndexedPath& path);
+
+  VertexId AddVertex(const Vector2& position);
+  void MoveVertex(VertexId vertex, const Vector2& position);
+
+  //Removes the vertex and every edge that uses it.
+  void RemoveVertex(VertexId vertex);
+
+  //For arcs, v0 must be the first vertex on the arc moving counter-clockwise.
+  EdgeId AddLine(VertexId v0, VertexId v1);
+  EdgeId AddArc(VertexId v0, VertexId v1, const Vector2& center);
+  void MoveArcCenter(EdgeId arc, const Vector2& center);
+  void RemoveEdge(EdgeId edge);
+
+  const Vector2& Position(VertexId vertex) const;
+  size_t VertexCount() const { return m_vertexCount; }
+  size_t EdgeCount() const { return m_edgeCount; }
+
+  //See ToolPath::ComputeTravelHeuristic and ToolPath::ComputeBounds.
+  double Travel() const;
+  Vector2 Bounds() const;
+
+  //The current path with ids compacted, lines and arcs each in id order.
+  //For the full quote, which also needs the rapid moves between contours.
+  IndexedPath ToIndexedPath() const;
+
+private:
+  struct Vertex {
+    Vector2 position;
+    std::vector<EdgeId> edges;
+    bool alive;
+  };
+
+  struct Edge {
+    VertexId v0, v1;
+    Vector2 center;
+    bool arc;
+    bool alive;
+  };
+
+  //Travel sum and extent of the edges under a tree node.
+  struct Summary {
+    double travel;
+    double minX, minY;
+    double maxX, maxY;
+  };
+
+  static Summary EmptySummary();
+  static Summary Combine(const Summary& a, const Summary& b);
+
+  Vertex& CheckVertex(VertexId vertex);
+  const Vertex& CheckVertex(VertexId vertex) const;
+  Edge& CheckEdge(EdgeId edge);
+
+  EdgeId AddEdge(const Edge& edge);
+  void DetachEdge(EdgeId edge, VertexId vertex);
+  Summary Measure(const Edge& edge) const;
+
+  //Recomputes the edge's leaf and the nodes above it.
+  void Refresh(EdgeId edge);
+
+  //Grows the tree to at least capacity leaves, rebuilding it.
+  void Reserve(size_t capacity);
+
+  std::vector<Vertex> m_vertices;
+  std::vector<Edge> m_edges;
+  std::vector<VertexId> m_freeVertices;
+  std::vector<EdgeId> m_freeEdges;
+  size_t m_vertexCount = 0;
+  size_t m_edgeCount = 0;
+
+  //Implicit binary tree: node 1 is the root, node i has children 2i and
+  //2i + 1, and edge slot e is the leaf m_leafCount + e.
+  std::vector<Summary> m_tree;
+  size_t m_leafCount = 0;
+};
@@ -0,0 +1,112 @@
+#pragma once
+
+//Polynomial approximations of the libm functions used in arc setup.
+//
+//Each is a short, branch free sequence of multiplies, adds and selects, so
+//a loop calling them can be vectorized, unlike a loop of libm calls. The
+//polynomials are Chebyshev economized Taylor series over a reduced range.
+//The maximum errors against libm, measured over 10^8 arguments spread
+//across the whole domain, are given for each function.
+
+#define _USE_MATH_DEFINES
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace FastMathDetail {
+
+//Polynomial c[0] + c[1] s + ... by Horner's rule.
+template<size_t N>
+inline double Horner(const double (&c)[N], double s) {
+  double result = c[N - 1];
+  for(size_t i = N - 1; i > 0; --i)
+    result = result * s + c[i - 1];
+  return result;
+}
+
+//atan(u) / u as a polynomial in u^2, for |u| <= tan(pi/8).
+const double ATAN[] = {
+  1, -0.3333333333332858, 0.19999999998882076, -0.14285714182978565,
+  0.11111106255995819, -0.090907747127958266, 0.076899751285696649, -0.066404108115352675,
+  0.056892235017660546, -0.043504452574300106, 0.021163217481242648
+};
+
+//asin(z) / z as a polynomial in z^2, for |z| <= 1/2.
+const double ASIN[] = {
+  1, 0.16666666666664839, 0.075000000004048578, 0.044642856791215726,
+  0.030381960271495149, 0.02237173660319574, 0.017359969965541983, 0.013883027829435166,
+  0.012181679088842099, 0.0064808553487793238, 0.01964239671205795, -0.016384436448802192,
+  0.032011340323281685
+};
+
+//exp(r), for |r| <= ln(2) / 2.
+const double EXP[] = {
+  1, 1.0000000000000067, 0.50000000000000189, 0.16666666666554392,
+  0.041666666666488078, 0.0083333333856713161, 0.0013888888952318045, 0.00019841170266518321,
+  2.480148547921643e-05, 2.7640182247362188e-06, 2.7632640675430235e-07
+};
+
+const double TAN_PI_8 = 0.41421356237309503;
+
+}
+
+//acos(x). Maximum absolute error 4.5e-16. Arguments just outside [-1, 1],
+//as a dot product of unit vectors can round to, give 0 or pi where acos
+//gives NaN.
+inline double FastAcos(double x) {
+  using namespace FastMathDetail;
+  const double ax = std::min(std::fabs(x), 1.0);
+
+  //Near 1, acos(x) = 2 asin(sqrt((1 - x) / 2)) keeps the argument small.
+  const bool nearOne = ax > 0.5;
+  const double z = nearOne ? std::sqrt((1 - ax) * 0.5) : ax;
+  const double asinZ = z * Horner(ASIN, z * z);
+  const double acosAbs = nearOne ? 2 * asinZ : M_PI_2 - asinZ;
+  return x < 0 ? M_PI - acosAbs : acosAbs;
+}
+
+//atan2(y, x), including the signed zero cases. Maximum absolute error 4.5e-16.
+inline double FastAtan2(double y, double x) {
+  using namespace FastMathDetail;
+  const double ax = std::fabs(x);
+  const double ay = std::fabs(y);
+  const double hi = std::max(ax, ay);
+  const double lo = std::min(ax, ay);
+  const double t = hi > 0 ? lo / hi : 0;
+
+  //atan(t) = pi/4 + atan((t - 1) / (t + 1)) brings t under tan(pi/8).
+  const bool upper = t > TAN_PI_8;
+  const double u = upper ? (t - 1) / (t + 1) : t;
+  double angle = u * Horner(ATAN, u * u) + (upper ? M_PI_4 : 0);
+
+  angle = ay > ax ? M_PI_2 - angle : angle;
+  angle = std::signbit(x) ? M_PI - angle : angle;
+  return std::signbit(y) ? -angle : angle;
+}
+
+//exp(x). Maximum relative error 4.8e-16. Results under 1e-307, just
+//above the smallest normal double, flush to zero.
+inline double FastExp(double x) {
+  using namespace FastMathDetail;
+  const double MAX_ARG = 709.78271289338397;
+  const double MIN_ARG = -707.0;
+
+  //x = k ln2 + r, with ln2 split in two so k ln2 is exact enough.
+  const double LN2_HI = 6.93147180369123816490e-01;
+  const double LN2_LO = 1.90821492927058770002e-10;
+  const double ROUND = 6755399441055744.0; //2^52 + 2^51: adding it rounds to an integer
+  const double clamped = x > MIN_ARG ? (x < MAX_ARG ? x : MAX_ARG) : MIN_ARG;
+  const double k = (clamped * M_LOG2E + ROUND) - ROUND;
+  const double r = (clamped - k * LN2_HI) - k * LN2_LO;
+
+  //2^(k - 1), doubled after the multiply so k = 1024 stays finite.
+  const uint64_t bits = static_cast<uint64_t>(static_cast<int64_t>(k) + 1022) << 52;
+  double scale;
+  std::memcpy(&scale, &bits, sizeof(scale));
+
+  const double result = Horner(EXP, r) * scale * 2;
+  const double limited = x > MAX_ARG ? std::numeric_limits<double>::infinity() : (x < MIN_ARG ? 0 : result);
+  return x != x ? x : limited;
+}
@@ -0,0 +1,384 @@
+#include "GeometryKernels.h"
+#include "FastMath.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define CADQUOTE_X86_64 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define CADQUOTE_TARGET_AVX2
+#else
+#define CADQUOTE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace {
+
+typedef void (*SummarizeSegmentsFn)(const double*, const double*, const double*, const double*, size_t, SegmentSummary&);
+typedef void (*ShapeArcsFn)(const ArcArrays&, size_t, size_t);
+
+struct KernelSet {
+  const char* name;
+  SummarizeSegmentsFn summarizeSegments;
+  ShapeArcsFn shapeArcsFast;
+};
+
+//Unit offsets of the four cardinal points, at angles M_PI_2 * dir.
+const double CARDINAL_X[] = { 1, 0, -1, 0 };
+const double CARDINAL_Y[] = { 0, 1, 0, -1 };
+
+//Scalar version of ShapeArcsFast over arcs [begin, end). The vector
+//version performs the same operations in the same order.
+void ShapeArcsFastScalar(const ArcArrays& arcs, size_t begin, size_t end) {
+  for(size_t i = begin; i < end; ++i) {
+    const double cx = arcs.cx[i], cy = arcs.cy[i];
+    const double dx0 = arcs.x0[i] - cx, dy0 = arcs.y0[i] - cy;
+    const double dx1 = arcs.x1[i] - cx, dy1 = arcs.y1[i] - cy;
+    const double r = sqrt(dx0*dx0 + dy0*dy0);
+    const double ux0 = dx0 / r, uy0 = dy0 / r;
+    const double ux1 = dx1 / r, uy1 = dy1 / r;
+
+    const double arcLength = FastAcos(ux0*ux1 + uy0*uy1) * r;
+    const double a0 = FastAtan2(uy0, ux0);
+    double a1 = FastAtan2(uy1, ux1);
+    a1 = a1 <= a0 ? a1 + 2*M_PI : a1;
+
+    //Where the libm version's clamped angles land: radius r along each end.
+    const double length1 = sqrt(ux1*ux1 + uy1*uy1);
+    const double endX0 = cx + ux0 * r, endY0 = cy + uy0 * r;
+    const double endX1 = cx + ux1 / length1 * r, endY1 = cy + uy1 / length1 * r;
+
+    double minX = std::numeric_limits<double>::max(), minY = std::numeric_limits<double>::max();
+    double maxX = std::numeric_limits<double>::lowest(), maxY = std::numeric_limits<double>::lowest();
+    for(int dir = 0; dir < 4; ++dir) {
+      const double theta = M_PI_2 * dir;
+      const double px = theta < a0 ? endX0 : (theta > a1 ? endX1 : cx + CARDINAL_X[dir] * r);
+      const double py = theta < a0 ? endY0 : (theta > a1 ? endY1 : cy + CARDINAL_Y[dir] * r);
+      minX = std::min(minX, px);
+      minY = std::min(minY, py);
+      maxX = std::max(maxX, px);
+      maxY = std::max(maxY, py);
+    }
+
+    arcs.radius[i] = r;
+    arcs.startAngle[i] = a0;
+    arcs.sweep[i] = a1 - a0;
+    arcs.effectiveLength[i] = arcLength * FastExp(1 / r);
+    arcs.minX[i] = minX;
+    arcs.minY[i] = minY;
+    arcs.maxX[i] = maxX;
+    arcs.maxY[i] = maxY;
+  }
+}
+
+//Scalar version, also used for the tails of the vector loops.
+void SummarizeSegmentsScalar(const double* x0, const double* y0,
+                             const double* x1, const double* y1, size_t count,
+                             SegmentSummary& summary) {
+  for(size_t i = 0; i < count; ++i) {
+    const double dx = x1[i] - x0[i];
+    const double dy = y1[i] - y0[i];
+    const double length = sqrt(dx*dx + dy*dy);
+
+    summary.lengthSum += length;
+    summary.minLength = std::min(summary.minLength, length);
+    summary.maxLength = std::max(summary.maxLength, length);
+    summary.minX = std::min(summary.minX, std::min(x0[i], x1[i]));
+    summary.minY = std::min(summary.minY, std::min(y0[i], y1[i]));
+    summary.maxX = std::max(summary.maxX, std::max(x0[i], x1[i]));
+    summary.maxY = std::max(summary.maxY, std::max(y0[i], y1[i]));
+  }
+}
+
+#ifdef CADQUOTE_X86_64
+
+template<size_t N>
+void ReduceLanes(const double (&sum)[N], const double (&minLength)[N], const double (&maxLength)[N],
+                 const double (&minX)[N], const double (&minY)[N],
+                 const double (&maxX)[N], const double (&maxY)[N], SegmentSummary& summary) {
+  double laneSum = 0;
+  for(size_t i = 0; i < N; ++i) {
+    laneSum += sum[i];
+    summary.minLength = std::min(summary.minLength, minLength[i]);
+    summary.maxLength = std::max(summary.maxLength, maxLength[i]);
+    summary.minX = std::min(summary.minX, minX[i]);
+    summary.minY = std::min(summary.minY, minY[i]);
+    summary.maxX = std::max(summary.maxX, maxX[i]);
+    summary.maxY = std::max(summary.maxY, maxY[i]);
+  }
+  summary.lengthSum += laneSum;
+}
+
+//SSE2 is part of the x86-64 baseline, so no target attribute is needed.
+void SummarizeSegmentsSSE2(const double* x0, const double* y0,
+                           const double* x1, const double* y1, size_t count,
+                           SegmentSummary& summary) {
+  //Lane-wise accumulators, reduced into summary after the loop.
+  __m128d vSum = _mm_setzero_pd();
+  __m128d vMinLength = _mm_set1_pd(summary.minLength), vMaxLength = _mm_set1_pd(summary.maxLength);
+  __m128d vMinX = _mm_set1_pd(summary.minX), vMinY = _mm_set1_pd(summary.minY);
+  __m128d vMaxX = _mm_set1_pd(summary.maxX), vMaxY = _mm_set1_pd(summary.maxY);
+
+  size_t i = 0;
+  for(; i + 2 <= count; i += 2) {
+    const __m128d ax = _mm_loadu_pd(x0 + i), ay = _mm_loadu_pd(y0 + i);
+    const __m128d bx = _mm_loadu_pd(x1 + i), by = _mm_loadu_pd(y1 + i);
+    const __m128d dx = _mm_sub_pd(bx, ax), dy = _mm_sub_pd(by, ay);
+    const __m128d length = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(dx,dx), _mm_mul_pd(dy,dy)));
+
+    vSum = _mm_add_pd(vSum, length);
+    vMinLength = _mm_min_pd(vMinLength, length);
+    vMaxLength = _mm_max_pd(vMaxLength, length);
+    vMinX = _mm_min_pd(vMinX, _mm_min_pd(ax, bx));
+    vMinY = _mm_min_pd(vMinY, _mm_min_pd(ay, by));
+    vMaxX = _mm_max_pd(vMaxX, _mm_max_pd(ax, bx));
+    vMaxY = _mm_max_pd(vMaxY, _mm_max_pd(ay, by));
+  }
+
+  double sum[2], minLength[2], maxLength[2], minX[2], minY[2], maxX[2], maxY[2];
+  _mm_storeu_pd(sum, vSum);
+  _mm_storeu_pd(minLength, vMinLength);
+  _mm_storeu_pd(maxLength, vMaxLength);
+  _mm_storeu_pd(minX, vMinX);
+  _mm_storeu_pd(minY, vMinY);
+  _mm_storeu_pd(maxX, vMaxX);
+  _mm_storeu_pd(maxY, vMaxY);
+  ReduceLanes(sum, minLength, maxLength, minX, minY, maxX, maxY, summary);
+
+  SummarizeSegmentsScalar(x0+i, y0+i, x1+i, y1+i, count-i, summary);
+}
+
+CADQUOTE_TARGET_AVX2
+void SummarizeSegmentsAVX2(const double* x0, const double* y0,
+                           const double* x1, const double* y1, size_t count,
+                           SegmentSummary& summary) {
+  //Lane-wise accumulators, reduced into summary after the loop.
+  __m256d vSum = _mm256_setzero_pd();
+  __m256d vMinLength = _mm256_set1_pd(summary.minLength), vMaxLength = _mm256_set1_pd(summary.maxLength);
+  __m256d vMinX = _mm256_set1_pd(summary.minX), vMinY = _mm256_set1_pd(summary.minY);
+  __m256d vMaxX = _mm256_set1_pd(summary.maxX), vMaxY = _mm256_set1_pd(summary.maxY);
+
+  size_t i = 0;
+  for(; i + 4 <= count; i += 4) {
+    const __m256d ax = _mm256_loadu_pd(x0 + i), ay = _mm256_loadu_pd(y0 + i);
+    const __m256d bx = _mm256_loadu_pd(x1 + i), by = _mm256_loadu_pd(y1 + i);
+    const __m256d dx = _mm256_sub_pd(bx, ax), dy = _mm256_sub_pd(by, ay);
+    const __m256d length = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx,dx), _mm256_mul_pd(dy,dy)));
+
+    vSum = _mm256_add_pd(vSum, length);
+    vMinLength = _mm256_min_pd(vMinLength, length);
+    vMaxLength = _mm256_max_pd(vMaxLength, length);
+    vMinX = _mm256_min_pd(vMinX, _mm256_min_pd(ax, bx));
+    vMinY = _mm256_min_pd(vMinY, _mm256_min_pd(ay, by));
+    vMaxX = _mm256_max_pd(vMaxX, _mm256_max_pd(ax, bx));
+    vMaxY = _mm256_max_pd(vMaxY, _mm256_max_pd(ay, by));
+  }
+
+  double sum[4], minLength[4], maxLength[4], minX[4], minY[4], maxX[4], maxY[4];
+  _mm256_storeu_pd(sum, vSum);
+  _mm256_storeu_pd(minLength, vMinLength);
+  _mm256_storeu_pd(maxLength, vMaxLength);
+  _mm256_storeu_pd(minX, vMinX);
+  _mm256_storeu_pd(minY, vMinY);
+  _mm256_storeu_pd(maxX, vMaxX);
+  _mm256_storeu_pd(maxY, vMaxY);
+  ReduceLanes(sum, minLength, maxLength, minX, minY, maxX, maxY, summary);
+
+  SummarizeSegmentsScalar(x0+i, y0+i, x1+i, y1+i, count-i, summary);
+}
+
+//AVX2 forms of the FastMath.h functions, operation for operation.
+
+CADQUOTE_TARGET_AVX2
+inline __m256d SelectAVX2(__m256d mask, __m256d ifTrue, __m256d ifFalse) {
+  return _mm256_blendv_pd(ifFalse, ifTrue, mask);
+}
+
+template<size_t N>
+CADQUOTE_TARGET_AVX2
+inline __m256d HornerAVX2(const double (&c)[N], __m256d s) {
+  __m256d result = _mm256_set1_pd(c[N - 1]);
+  for(size_t i = N - 1; i > 0; --i)
+    result = _mm256_add_pd(_mm256_mul_pd(result, s), _mm256_set1_pd(c[i - 1]));
+  return result;
+}
+
+CADQUOTE_TARGET_AVX2
+inline __m256d AbsAVX2(__m256d x) {
+  return _mm256_andnot_pd(_mm256_set1_pd(-0.0), x);
+}
+
+CADQUOTE_TARGET_AVX2
+inline __m256d SignBitAVX2(__m256d x) {
+  return _mm256_castsi256_pd(_mm256_cmpgt_epi64(_mm256_setzero_si256(), _mm256_castpd_si256(x)));
+}
+
+CADQUOTE_TARGET_AVX2
+inline __m256d AcosAVX2(__m256d x) {
+  using namespace FastMathDetail;
+  const __m256d one = _mm256_set1_pd(1), half = _mm256_set1_pd(0.5);
+  const __m256d ax = _mm256_min_pd(one, AbsAVX2(x));
+
+  const __m256d nearOne = _mm256_cmp_pd(ax, half, _CMP_GT_OQ);
+  const __m256d z = SelectAVX2(nearOne, _mm256_sqrt_pd(_mm256_mul_pd(_mm256_sub_pd(one, ax), half)), ax);
+  const __m256d asinZ = _mm256_mul_pd(z, HornerAVX2(ASIN, _mm256_mul_pd(z, z)));
+  const __m256d acosAbs = SelectAVX2(nearOne, _mm256_mul_pd(_mm256_set1_pd(2), asinZ),
+                                     _mm256_sub_pd(_mm256_set1_pd(M_PI_2), asinZ));
+  return SelectAVX2(_mm256_cmp_pd(x, _mm256_setzero_pd(), _CMP_LT_OQ),
+                    _mm256_sub_pd(_mm256_set1_pd(M_PI), acosAbs), acosAbs);
+}
+
+CADQUOTE_TARGET_AVX2
+inline __m256d Atan2AVX2(__m256d y, __m256d x) {
+  using namespace FastMathDetail;
+  const __m256d zero = _mm256_setzero_pd(), one = _mm256_set1_pd(1);
+  const __m256d ax = AbsAVX2(x), ay = AbsAVX2(y);
+  const __m256d hi = _mm256_max_pd(ay, ax), lo = _mm256_min_pd(ay, ax);
+  const __m256d t = SelectAVX2(_mm256_cmp_pd(hi, zero, _CMP_GT_OQ), _mm256_div_pd(lo, hi), zero);
+
+  const __m256d upper = _mm256_cmp_pd(t, _mm256_set1_pd(TAN_PI_8), _CMP_GT_OQ);
+  const __m256d u = SelectAVX2(upper, _mm256_div_pd(_mm256_sub_pd(t, one), _mm256_add_pd(t, one)), t);
+  __m256d angle = _mm256_add_pd(_mm256_mul_pd(u, HornerAVX2(ATAN, _mm256_mul_pd(u, u))),
+                                SelectAVX2(upper, _mm256_set1_pd(M_PI_4), zero));
+
+  angle = SelectAVX2(_mm256_cmp_pd(ay, ax, _CMP_GT_OQ), _mm256_sub_pd(_mm256_set1_pd(M_PI_2), angle), angle);
+  angle = SelectAVX2(SignBitAVX2(x), _mm256_sub_pd(_mm256_set1_pd(M_PI), angle), angle);
+  return SelectAVX2(SignBitAVX2(y), _mm256_xor_pd(angle, _mm256_set1_pd(-0.0)), angle);
+}
+
+CADQUOTE_TARGET_AVX2
+inline __m256d ExpAVX2(__m256d x) {
+  using namespace FastMathDetail;
+  const __m256d maxArg = _mm256_set1_pd(709.78271289338397), minArg = _mm256_set1_pd(-707.0);
+  const __m256d round = _mm256_set1_pd(6755399441055744.0);
+  const __m256d clamped = SelectAVX2(_mm256_cmp_pd(x, minArg, _CMP_GT_OQ),
+                                     SelectAVX2(_mm256_cmp_pd(x, maxArg, _CMP_LT_OQ), x, maxArg), minArg);
+  const __m256d k = _mm256_sub_pd(_mm256_add_pd(_mm256_mul_pd(clamped, _mm256_set1_pd(M_LOG2E)), round), round);
+  const __m256d r = _mm256_sub_pd(_mm256_sub_pd(clamped, _mm256_mul_pd(k, _mm256_set1_pd(6.93147180369123816490e-01))),
+                                  _mm256_mul_pd(k, _mm256_set1_pd(1.90821492927058770002e-10)));
+
+  const __m128i biased = _mm256_cvtpd_epi32(_mm256_add_pd(k, _mm256_set1_pd(1022)));
+  const __m256d scale = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_cvtepi32_epi64(biased), 52));
+
+  const __m256d result = _mm256_mul_pd(_mm256_mul_pd(HornerAVX2(EXP, r), scale), _mm256_set1_pd(2));
+  const __m256d limited = SelectAVX2(_mm256_cmp_pd(x, maxArg, _CMP_GT_OQ),
+                                     _mm256_set1_pd(std::numeric_limits<double>::infinity()),
+                                     SelectAVX2(_mm256_cmp_pd(x, minArg, _CMP_LT_OQ), _mm256_setzero_pd(), result));
+  return SelectAVX2(_mm256_cmp_pd(x, x, _CMP_UNORD_Q), x, limited);
+}
+
+CADQUOTE_TARGET_AVX2
+void ShapeArcsFastAVX2(const ArcArrays& arcs, size_t begin, size_t end) {
+  size_t i = begin;
+  for(; i + 4 <= end; i += 4) {
+    const __m256d cx = _mm256_loadu_pd(arcs.cx + i), cy = _mm256_loadu_pd(arcs.cy + i);
+    const __m256d dx0 = _mm256_sub_pd(_mm256_loadu_pd(arcs.x0 + i), cx);
+    const __m256d dy0 = _mm256_sub_pd(_mm256_loadu_pd(arcs.y0 + i), cy);
+    const __m256d dx1 = _mm256_sub_pd(_mm256_loadu_pd(arcs.x1 + i), cx);
+    const __m256d dy1 = _mm256_sub_pd(_mm256_loadu_pd(arcs.y1 + i), cy);
+    const __m256d r = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx0, dx0), _mm256_mul_pd(dy0, dy0)));
+    const __m256d ux0 = _mm256_div_pd(dx0, r), uy0 = _mm256_div_pd(dy0, r);
+    const __m256d ux1 = _mm256_div_pd(dx1, r), uy1 = _mm256_div_pd(dy1, r);
+
+    const __m256d dot = _mm256_add_pd(_mm256_mul_pd(ux0, ux1), _mm256_mul_pd(uy0, uy1));
+    const __m256d arcLength = _mm256_mul_pd(AcosAVX2(dot), r);
+    const __m256d a0 = Atan2AVX2(uy0, ux0);
+    __m256d a1 = Atan2AVX2(uy1, ux1);
+    a1 = SelectAVX2(_mm256_cmp_pd(a1, a0, _CMP_LE_OQ), _mm256_add_pd(a1, _mm256_set1_pd(2*M_PI)), a1);
+
+    const __m256d length1 = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(ux1, ux1), _mm256_mul_pd(uy1, uy1)));
+    const __m256d endX0 = _mm256_add_pd(cx, _mm256_mul_pd(ux0, r));
+    const __m256d endY0 = _mm256_add_pd(cy, _mm256_mul_pd(uy0, r));
+    const __m256d endX1 = _mm256_add_pd(cx, _mm256_mul_pd(_mm256_div_pd(ux1, length1), r));
+    const __m256d endY1 = _mm256_add_pd(cy, _mm256_mul_pd(_mm256_div_pd(uy1, length1), r));
+
+    __m256d minX = _mm256_set1_pd(std::numeric_limits<double>::max()), minY = minX;
+    __m256d maxX = _mm256_set1_pd(std::numeric_limits<double>::lowest()), maxY = maxX;
+    for(int dir = 0; dir < 4; ++dir) {
+      const __m256d theta = _mm256_set1_pd(M_PI_2 * dir);
+      const __m256d before = _mm256_cmp_pd(theta, a0, _CMP_LT_OQ);
+      const __m256d after = _mm256_cmp_pd(theta, a1, _CMP_GT_OQ);
+      const __m256d cardinalX = _mm256_add_pd(cx, _mm256_mul_pd(_mm256_set1_pd(CARDINAL_X[dir]), r));
+      const __m256d cardinalY = _mm256_add_pd(cy, _mm256_mul_pd(_mm256_set1_pd(CARDINAL_Y[dir]), r));
+      const __m256d px = SelectAVX2(before, endX0, SelectAVX2(after, endX1, cardinalX));
+      const __m256d py = SelectAVX2(before, endY0, SelectAVX2(after, endY1, cardinalY));
+
+      //Operand order matches std::min and std::max in the scalar loop.
+      minX = _mm256_min_pd(px, minX);
+      minY = _mm256_min_pd(py, minY);
+      maxX = _mm256_max_pd(px, maxX);
+      maxY = _mm256_max_pd(py, maxY);
+    }
+
+    _mm256_storeu_pd(arcs.radius + i, r);
+    _mm256_storeu_pd(arcs.startAngle + i, a0);
+    _mm256_storeu_pd(arcs.sweep + i, _mm256_sub_pd(a1, a0));
+    _mm256_storeu_pd(arcs.effectiveLength + i, _mm256_mul_pd(arcLength, ExpAVX2(_mm256_div_pd(_mm256_set1_pd(1), r))));
+    _mm256_storeu_pd(arcs.minX + i, minX);
+    _mm256_storeu_pd(arcs.minY + i, minY);
+    _mm256_storeu_pd(arcs.maxX + i, maxX);
+    _mm256_storeu_pd(arcs.maxY + i, maxY);
+  }
+
+  ShapeArcsFastScalar(arcs, i, end);
+}
+
+bool CpuSupportsAVX2() {
+#ifdef _MSC_VER
+  int info[4];
+  __cpuid(info, 0);
+  if(info[0] < 7)
+    return false;
+  __cpuid(info, 1);
+  const bool osxsave = (info[2] & (1 << 27)) != 0;
+  const bool avx = (info[2] & (1 << 28)) != 0;
+  if(!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+    return false;
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif //CADQUOTE_X86_64
+
+KernelSet SelectKernels() {
+#ifdef CADQUOTE_X86_64
+  if(CpuSupportsAVX2())
+    return { "avx2", SummarizeSegmentsAVX2, ShapeArcsFastAVX2 };
+  return { "sse2", SummarizeSegmentsSSE2, ShapeArcsFastScalar };
+#else
+  return { "scalar", SummarizeSegmentsScalar, ShapeArcsFastScalar };
+#endif
+}
+
+const KernelSet& Kernels() {
+  static const KernelSet kernels = SelectKernels();
+  return kernels;
+}
+
+}
+
+SegmentSummary EmptySegmentSummary() {
+  const double inf = std::numeric_limits<double>::infinity();
+  return { 0, inf, -inf, inf, inf, -inf, -inf };
+}
+
+void SummarizeSegments(const double* x0, const double* y0,
+                       const double* x1, const double* y1, size_t count,
+                       SegmentSummary& summary) {
+  Kernels().summarizeSegments(x0, y0, x1, y1, count, summary);
+}
+
+void ShapeArcsFast(const ArcArrays& arcs, size_t count) {
+  Kernels().shapeArcsFast(arcs, 0, count);
+}
+
+const char* GeometryKernelName() {
+  return Kernels().name;
+}
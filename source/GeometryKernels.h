@@ -0,0 +1,47 @@
+// Bulk geometry kernels operating on structure-of-arrays edge data.
+// Each kernel has a scalar, SSE2 and AVX2 implementation; the widest one the
+// running cpu supports is picked once, on first use. ShapeArcsFast has no
+// SSE2 version, since two lanes don't pay for its blends, and uses the
+// scalar one there.
+//
+// The vector versions of SummarizeSegments only change the order of the
+// floating point additions, so their results agree with the scalar ones to
+// within a relative 1e-12. ShapeArcsFast gives identical results on every
+// kernel.
+#pragma once
+#include <cstddef>
+
+//Running summary of a set of segments, see SummarizeSegments.
+struct SegmentSummary {
+  double lengthSum;
+  double minLength, maxLength;
+  double minX, minY;
+  double maxX, maxY;
+};
+
+//Zero length and inverted (infinite) extents, the identity for SummarizeSegments.
+SegmentSummary EmptySegmentSummary();
+
+//Folds count segments (x0,y0)->(x1,y1) into summary. Lengths and extents
+//are gathered in the same pass, so each coordinate is loaded once.
+void SummarizeSegments(const double* x0, const double* y0,
+                       const double* x1, const double* y1, size_t count,
+                       SegmentSummary& summary);
+
+//Parallel arrays of count arcs for ShapeArcsFast: the endpoints and center
+//of each, with v0 the first vertex counter-clockwise, and the geometry
+//ToolPath derives from them.
+struct ArcArrays {
+  const double *x0, *y0, *x1, *y1, *cx, *cy;
+  double *radius, *startAngle, *sweep, *effectiveLength;
+  double *minX, *minY, *maxX, *maxY;
+};
+
+//The same derived geometry as ToolPath's libm based arc setup, with the
+//FastMath.h approximations for acos, atan2 and exp. The extents need no
+//trig at all: a cardinal point inside the arc is the center plus or minus
+//the radius along an axis, and one clamped to the arc is an endpoint.
+void ShapeArcsFast(const ArcArrays& arcs, size_t count);
+
+//Name of the kernel set in use ("avx2", "sse2" or "scalar").
+const char* GeometryKernelName();
@@ -0,0 +1,18 @@
+#include "IndexedPath.h"
+#include "ToolPath.h"
+
+ToolPath MakeToolPath(const IndexedPath& path) {
+  ToolPath toolPath;
+  MakeToolPath(path, toolPath);
+  return toolPath;
+}
+
+void MakeToolPath(const IndexedPath& path, ToolPath& out) {
+  out.Clear();
+  out.Reserve(path.lines.size(), path.arcs.size());
+
+  for(const auto& line : path.lines)
+    out.AddLineSegment(path.vertices[line.v0], path.vertices[line.v1]);
+
+  out.AddCircularArcs(path.vertices.data(), path.arcs.data(), path.arcs.size());
+}
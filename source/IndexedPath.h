@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Vector2.h"
+#include <cstdint>
+#include <vector>
+
+class ToolPath;
+
+//Path document with its edges referring to vertices by index.
+//This is the common form the loaders and converters produce before a
+//ToolPath is built, and the layout the binary format stores on disk.
+struct IndexedPath {
+  struct Line {
+    uint32_t v0, v1;
+  };
+
+  //v0 is the first vertex on the arc, moving counter-clockwise.
+  struct Arc {
+    uint32_t v0, v1;
+    Vector2 center;
+  };
+
+  std::vector<Vector2> vertices;
+  std::vector<Line> lines;
+  std::vector<Arc> arcs;
+};
+
+ToolPath MakeToolPath(const IndexedPath& path);
+
+//Refills out from path, reusing out's storage.
+void MakeToolPath(const IndexedPath& path, ToolPath& out);
@@ -0,0 +1,372 @@
+#include "JsonCursor.h"
+#include "NumberParser.h"
+
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define CADQUOTE_X86_64 1
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace {
+
+bool IsWhitespace(char c) {
+  return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+bool IsDigit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+#ifdef CADQUOTE_X86_64
+unsigned FirstSetBit(unsigned mask) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return index;
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+#endif
+
+void AppendUtf8(std::string& out, unsigned codepoint) {
+  if(codepoint < 0x80) {
+    out.push_back(static_cast<char>(codepoint));
+  }
+  else if(codepoint < 0x800) {
+    out.push_back(static_cast<char>(0xc0 | (codepoint >> 6)));
+    out.push_back(static_cast<char>(0x80 | (codepoint & 0x3f)));
+  }
+  else if(codepoint < 0x10000) {
+    out.push_back(static_cast<char>(0xe0 | (codepoint >> 12)));
+    out.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3f)));
+    out.push_back(static_cast<char>(0x80 | (codepoint & 0x3f)));
+  }
+  else {
+    out.push_back(static_cast<char>(0xf0 | (codepoint >> 18)));
+    out.push_back(static_cast<char>(0x80 | ((codepoint >> 12) & 0x3f)));
+    out.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3f)));
+    out.push_back(static_cast<char>(0x80 | (codepoint & 0x3f)));
+  }
+}
+
+//Returns the first byte in [pos, end) that ends a plain run of string
+//characters: a quote, a backslash or a control character.
+const char* FindStringSpecial(const char* pos, const char* end) {
+#ifdef CADQUOTE_X86_64
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i control = _mm_set1_epi8(0x1f);
+  for(; end - pos >= 16; pos += 16) {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+    const __m128i special = _mm_or_si128(
+      _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+      _mm_cmpeq_epi8(_mm_max_epu8(chunk, control), control));
+    const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(special));
+    if(mask != 0)
+      return pos + FirstSetBit(mask);
+  }
+#endif
+  for(; pos != end; ++pos) {
+    const unsigned char c = static_cast<unsigned char>(*pos);
+    if(c == '"' || c == '\\' || c < 0x20)
+      break;
+  }
+  return pos;
+}
+
+//Returns the first byte in [pos, end) that opens or closes a string,
+//object or array, or separates members.
+const char* FindStructural(const char* pos, const char* end) {
+#ifdef CADQUOTE_X86_64
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i comma = _mm_set1_epi8(',');
+  const __m128i openBrace = _mm_set1_epi8('{');
+  const __m128i closeBrace = _mm_set1_epi8('}');
+  const __m128i openBracket = _mm_set1_epi8('[');
+  const __m128i closeBracket = _mm_set1_epi8(']');
+  for(; end - pos >= 16; pos += 16) {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+    const __m128i structural = _mm_or_si128(
+      _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, comma)),
+      _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, openBrace), _mm_cmpeq_epi8(chunk, closeBrace)),
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, openBracket), _mm_cmpeq_epi8(chunk, closeBracket))));
+    const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(structural));
+    if(mask != 0)
+      return pos + FirstSetBit(mask);
+  }
+#endif
+  for(; pos != end; ++pos) {
+    const char c = *pos;
+    if(c == '"' || c == ',' || c == '{' || c == '}' || c == '[' || c == ']')
+      break;
+  }
+  return pos;
+}
+
+bool IsBlank(const char* begin, const char* end) {
+  for(; begin != end; ++begin)
+    if(!IsWhitespace(*begin))
+      return false;
+  return true;
+}
+
+}
+
+JsonCursor::JsonCursor(const char* begin, const char* end) : m_begin(begin), m_pos(begin), m_end(end) {}
+
+JsonCursor::JsonCursor(const char* document, const char* begin, const char* end) : m_begin(document), m_pos(begin), m_end(end) {}
+
+void JsonCursor::FailAt(size_t offset, const std::string& message) const {
+  throw std::runtime_error("Error parsing json: " + message + " at byte " + std::to_string(offset));
+}
+
+void JsonCursor::SkipWhitespace() {
+#ifdef CADQUOTE_X86_64
+  //Indented documents spend most of their bytes on runs of spaces.
+  if(m_pos != m_end && IsWhitespace(*m_pos)) {
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i carriageReturn = _mm_set1_epi8('\r');
+    const __m128i tab = _mm_set1_epi8('\t');
+    while(m_end - m_pos >= 16) {
+      const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_pos));
+      const __m128i whitespace = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, newline)),
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, carriageReturn), _mm_cmpeq_epi8(chunk, tab)));
+      const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(whitespace)) ^ 0xffff;
+      if(mask != 0) {
+        m_pos += FirstSetBit(mask);
+        return;
+      }
+      m_pos += 16;
+    }
+  }
+#endif
+  while(m_pos != m_end && IsWhitespace(*m_pos))
+    ++m_pos;
+}
+
+char JsonCursor::Peek() {
+  SkipWhitespace();
+  return m_pos == m_end ? 0 : *m_pos;
+}
+
+bool JsonCursor::TryConsume(char c) {
+  if(Peek() != c)
+    return false;
+  ++m_pos;
+  return true;
+}
+
+void JsonCursor::Expect(char c) {
+  if(!TryConsume(c)) {
+    if(m_pos == m_end)
+      Fail(std::string("expected '") + c + "' but reached end of input");
+    Fail(std::string("expected '") + c + "'");
+  }
+}
+
+void JsonCursor::ExpectEnd() {
+  if(Peek() != 0 || m_pos != m_end)
+    Fail("unexpected data after document");
+}
+
+unsigned JsonCursor::ReadHex4() {
+  if(m_end - m_pos < 4)
+    Fail("truncated \\u escape");
+
+  unsigned value = 0;
+  for(int i = 0; i < 4; ++i, ++m_pos) {
+    const char c = *m_pos;
+    value <<= 4;
+    if(IsDigit(c))
+      value |= c - '0';
+    else if(c >= 'a' && c <= 'f')
+      value |= c - 'a' + 10;
+    else if(c >= 'A' && c <= 'F')
+      value |= c - 'A' + 10;
+    else
+      Fail("invalid \\u escape");
+  }
+  return value;
+}
+
+JsonString JsonCursor::ReadString(std::string& scratch) {
+  Expect('"');
+
+  //Common case: no escapes, so the string is a view of the document.
+  const char* start = m_pos;
+  m_pos = FindStringSpecial(m_pos, m_end);
+  if(m_pos != m_end && *m_pos == '"')
+    return { start, static_cast<size_t>(m_pos++ - start) };
+
+  scratch.assign(start, m_pos);
+  while(true) {
+    if(m_pos == m_end)
+      Fail("unterminated string");
+
+    const char c = *m_pos;
+    if(c == '"') {
+      ++m_pos;
+      return { scratch.data(), scratch.size() };
+    }
+    if(static_cast<unsigned char>(c) < 0x20)
+      Fail("control character in string");
+
+    //c is a backslash.
+    if(++m_pos == m_end)
+      Fail("unterminated string");
+    switch(*m_pos++) {
+      case '"': scratch.push_back('"'); break;
+      case '\\': scratch.push_back('\\'); break;
+      case '/': scratch.push_back('/'); break;
+      case 'b': scratch.push_back('\b'); break;
+      case 'f': scratch.push_back('\f'); break;
+      case 'n': scratch.push_back('\n'); break;
+      case 'r': scratch.push_back('\r'); break;
+      case 't': scratch.push_back('\t'); break;
+      case 'u': {
+        unsigned codepoint = ReadHex4();
+        if(codepoint >= 0xd800 && codepoint <= 0xdbff) {
+          if(m_end - m_pos < 2 || m_pos[0] != '\\' || m_pos[1] != 'u')
+            Fail("unpaired surrogate in \\u escape");
+          m_pos += 2;
+          const unsigned low = ReadHex4();
+          if(low < 0xdc00 || low > 0xdfff)
+            Fail("unpaired surrogate in \\u escape");
+          codepoint = 0x10000 + ((codepoint - 0xd800) << 10) + (low - 0xdc00);
+        }
+        else if(codepoint >= 0xdc00 && codepoint <= 0xdfff) {
+          Fail("unpaired surrogate in \\u escape");
+        }
+        AppendUtf8(scratch, codepoint);
+        break;
+      }
+      default:
+        --m_pos;
+        Fail("invalid escape in string");
+    }
+
+    const char* run = m_pos;
+    m_pos = FindStringSpecial(m_pos, m_end);
+    scratch.append(run, m_pos);
+  }
+}
+
+double JsonCursor::ReadNumber() {
+  SkipWhitespace();
+  double value;
+  const char* next = ParseJsonNumber(m_pos, m_end, value);
+  if(!next)
+    Fail("invalid number");
+  m_pos = next;
+  return value;
+}
+
+bool JsonCursor::TryReadInteger(uint64_t& value) {
+  SkipWhitespace();
+  const char* next = ParseJsonInteger(m_pos, m_end, value);
+  if(!next)
+    return false;
+  m_pos = next;
+  return true;
+}
+
+void JsonCursor::SkipLiteral(const char* literal) {
+  const size_t length = strlen(literal);
+  if(static_cast<size_t>(m_end - m_pos) < length || memcmp(m_pos, literal, length) != 0)
+    Fail("invalid value");
+  m_pos += length;
+}
+
+void JsonCursor::SkipValue() {
+  std::string scratch;
+  switch(Peek()) {
+    case '{':
+      ParseObject([&](const JsonString&) { SkipValue(); });
+      break;
+    case '[':
+      ParseArray([&](size_t) { SkipValue(); });
+      break;
+    case '"':
+      ReadString(scratch);
+      break;
+    case 't':
+      SkipLiteral("true");
+      break;
+    case 'f':
+      SkipLiteral("false");
+      break;
+    case 'n':
+      SkipLiteral("null");
+      break;
+    case 0:
+      if(m_pos == m_end)
+        Fail("unexpected end of input");
+      Fail("invalid value");
+    default:
+      ReadNumber();
+      break;
+  }
+}
+
+void JsonCursor::SplitObjectMembers(size_t targetBytes, std::vector<JsonRange>& ranges) {
+  const size_t offset = Offset();
+  const size_t firstRange = ranges.size();
+  Expect('{');
+
+  const char* rangeStart = m_pos;
+  size_t depth = 0;
+  while(true) {
+    m_pos = FindStructural(m_pos, m_end);
+    if(m_pos == m_end)
+      FailAt(offset, "unterminated object");
+
+    switch(*m_pos++) {
+      case '"':
+        //Skip the string body; escapes only matter for finding its end.
+        while(true) {
+          m_pos = FindStringSpecial(m_pos, m_end);
+          if(m_pos == m_end)
+            FailAt(offset, "unterminated object");
+          if(*m_pos == '"') {
+            ++m_pos;
+            break;
+          }
+          if(*m_pos == '\\' && m_end - m_pos >= 2)
+            m_pos += 2;
+          else
+            ++m_pos;
+        }
+        break;
+      case '{':
+      case '[':
+        ++depth;
+        break;
+      case '}':
+      case ']':
+        if(depth == 0) {
+          if(m_pos[-1] != '}')
+            Fail("mismatched bracket");
+          const char* last = m_pos - 1;
+          if(ranges.size() > firstRange || !IsBlank(rangeStart, last))
+            ranges.push_back({ rangeStart, last });
+          return;
+        }
+        --depth;
+        break;
+      case ',':
+        if(depth == 0 && static_cast<size_t>(m_pos - rangeStart) > targetBytes) {
+          ranges.push_back({ rangeStart, m_pos - 1 });
+          rangeStart = m_pos;
+        }
+        break;
+    }
+  }
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+//A string read by JsonCursor. Points straight into the document when the
+//string has no escapes, otherwise at the caller's scratch buffer.
+struct JsonString {
+  const char* data;
+  size_t size;
+
+  bool operator==(const char* text) const {
+    return size == strlen(text) && memcmp(data, text, size) == 0;
+  }
+  bool operator!=(const char* text) const { return !(*this == text); }
+  std::string ToString() const { return std::string(data, size); }
+};
+
+//A byte range of the document, such as a run of object members.
+struct JsonRange {
+  const char* begin;
+  const char* end;
+};
+
+//Pull parser over a json document held in contiguous memory, typically a
+//mapped file. The caller drives it in the shape it expects, so nothing is
+//copied or materialized unless asked for. Whitespace and string bodies are
+//scanned 16 bytes at a time where SSE2 is available.
+//
+//Every failure throws a runtime_error of the form
+//"Error parsing json: <message> at byte <offset>".
+class JsonCursor {
+public:
+  JsonCursor(const char* begin, const char* end);
+
+  //Cursor over part of a document; offsets stay relative to document.
+  JsonCursor(const char* document, const char* begin, const char* end);
+
+  //Skips whitespace and returns the next byte without consuming it, or 0 at the end.
+  char Peek();
+
+  //Skips whitespace and consumes c if it comes next.
+  bool TryConsume(char c);
+  void Expect(char c);
+
+  //Reads a string value. Escaped strings are decoded into scratch.
+  JsonString ReadString(std::string& scratch);
+  double ReadNumber();
+
+  //Reads a plain non-negative integer that fits in 64 bits. Leaves the
+  //cursor where it was and returns false for any other value.
+  bool TryReadInteger(uint64_t& value);
+  void SkipValue();
+
+  //Requires that only whitespace is left.
+  void ExpectEnd();
+
+  //Calls onMember(key) for each member of an object; onMember must consume
+  //the member's value. The key is only valid until the value is read.
+  template<typename Fn>
+  void ParseObject(Fn onMember);
+
+  //Parses a bare run of members, as produced by SplitObjectMembers, up to
+  //the end of the cursor's range.
+  template<typename Fn>
+  void ParseMembers(Fn onMember);
+
+  //Skips the object that comes next with a structural scan that only
+  //tracks strings and nesting, and cuts its members into ranges of at
+  //least targetBytes at top level commas. The ranges are not validated;
+  //parse them with ParseMembers. An empty object yields no ranges.
+  void SplitObjectMembers(size_t targetBytes, std::vector<JsonRange>& ranges);
+
+  //Calls onItem(index) for each element of an array; onItem must consume
+  //the element. Returns the element count.
+  template<typename Fn>
+  size_t ParseArray(Fn onItem);
+
+  size_t Offset() const { return static_cast<size_t>(m_pos - m_begin); }
+
+  [[noreturn]] void Fail(const std::string& message) const { FailAt(Offset(), message); }
+  [[noreturn]] void FailAt(size_t offset, const std::string& message) const;
+
+private:
+  void SkipWhitespace();
+  void SkipLiteral(const char* literal);
+  unsigned ReadHex4();
+
+  template<typename Fn>
+  void ParseMemberList(Fn onMember);
+
+  const char* m_begin;
+  const char* m_pos;
+  const char* m_end;
+};
+
+template<typename Fn>
+void JsonCursor::ParseMemberList(Fn onMember) {
+  std::string scratch;
+  do {
+    if(Peek() != '"')
+      Fail("expected object key");
+    const auto key = ReadString(scratch);
+    Expect(':');
+    onMember(key);
+  } while(TryConsume(','));
+}
+
+template<typename Fn>
+void JsonCursor::ParseObject(Fn onMember) {
+  Expect('{');
+  if(TryConsume('}'))
+    return;
+  ParseMemberList(onMember);
+  Expect('}');
+}
+
+template<typename Fn>
+void JsonCursor::ParseMembers(Fn onMember) {
+  ParseMemberList(onMember);
+  ExpectEnd();
+}
+
+template<typename Fn>
+size_t JsonCursor::ParseArray(Fn onItem) {
+  Expect('[');
+  if(TryConsume(']'))
+    return 0;
+
+  size_t index = 0;
+  do {
+    onItem(index++);
+  } while(TryConsume(','));
+  Expect(']');
+  return index;
+}
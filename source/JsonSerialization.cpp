@@ -1,6 +1,8 @@
 #include "JsonSerialization.h"
 #include "picojson.h"
 
+#include <limits>
+
 Vector2 ParseVector(const picojson::value& xyPair) {
   return { xyPair.get("X").get<double>(), xyPair.get("Y").get<double>() };
 }
@@ -9,4 +11,49 @@ Vector2 ParseVertex(const picojson::value& vertices, const picojson::value& id)
   const auto& vertex = vertices.get(id.to_str());
   const auto& position = vertex.get("Position");
   return ParseVector(position);
-}
\ No newline at end of file
+}
+
+namespace {
+
+void WriteVectorJson(const Vector2& v, std::ostream& out) {
+  out << "{ \"X\": " << v.x << ", \"Y\": " << v.y << " }";
+}
+
+void WriteEdgeJson(size_t id, const char* type, uint32_t v0, uint32_t v1, std::ostream& out) {
+  out << "    \"" << id << "\": {\n";
+  out << "      \"Type\": \"" << type << "\",\n";
+  out << "      \"Vertices\": [" << v0 << ", " << v1 << "]";
+}
+
+}
+
+void WritePathJson(const IndexedPath& path, std::ostream& out) {
+  const auto oldPrecision = out.precision(std::numeric_limits<double>::max_digits10);
+  size_t edgeId = 0;
+
+  out << "{\n  \"Edges\": {";
+  for(const auto& line : path.lines) {
+    out << (edgeId == 0 ? "\n" : ",\n");
+    WriteEdgeJson(edgeId++, "LineSegment", line.v0, line.v1, out);
+    out << "\n    }";
+  }
+  for(const auto& arc : path.arcs) {
+    out << (edgeId == 0 ? "\n" : ",\n");
+    WriteEdgeJson(edgeId++, "CircularArc", arc.v0, arc.v1, out);
+    out << ",\n      \"Center\": ";
+    WriteVectorJson(arc.center, out);
+    //Clockwise from v1 keeps v0 as the first vertex moving counter-clockwise.
+    out << ",\n      \"ClockwiseFrom\": " << arc.v1 << "\n    }";
+  }
+
+  out << "\n  },\n  \"Vertices\": {";
+  for(size_t i = 0; i < path.vertices.size(); ++i) {
+    out << (i == 0 ? "\n" : ",\n");
+    out << "    \"" << i << "\": { \"Position\": ";
+    WriteVectorJson(path.vertices[i], out);
+    out << " }";
+  }
+  out << "\n  }\n}\n";
+
+  out.precision(oldPrecision);
+}
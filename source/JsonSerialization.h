@@ -1,6 +1,8 @@
 #pragma once
 
+#include "IndexedPath.h"
 #include "Vector2.h"
+#include <ostream>
 
 namespace picojson {
   class value;
@@ -11,3 +13,9 @@ namespace picojson {
 
 Vector2 ParseVector(const picojson::value& xyPair);
 Vector2 ParseVertex(const picojson::value& vertices, const picojson::value& id);
+
+//Data type -> JSON conversion functions
+
+//Writes path in the path document format. Vertex and edge ids are the
+//indices into the IndexedPath arrays.
+void WritePathJson(const IndexedPath& path, std::ostream& out);
@@ -1,8 +1,34 @@
 #include "MachineInfo.h"
+#include "MotionPlanner.h"
 #include "Vector2.h"
+
+double ComputeCutTime(const MachineInfo& tooling, double cutLength, double rapidLength) {
+  
+  return cutLength / tooling.max_speed + rapidLength / tooling.rapid_speed;
+}
+
+double ComputeCutTime(const MachineInfo& tooling, const CutSequence& cuts, double cutLength, double rapidLength) {
+  if(!(tooling.acceleration > 0))
+    return ComputeCutTime(tooling, cutLength, rapidLength);
+
+  const double cutting = ComputeKinematicTime(cuts, tooling.max_speed, tooling.acceleration, tooling.junction_deviation);
+  return cutting + rapidLength / tooling.rapid_speed;
+}
+
 double ComputeCost(const MachineInfo& tooling, const Vector2& bounds, double cutTime) {
   
   const auto area = (bounds.x + tooling.padding) * (bounds.y + tooling.padding);
   
   return (area * tooling.cost_per_sq_in) + (cutTime * tooling.cost_per_s);
-}
\ No newline at end of file
+}
+
+Vector2 ChargedBounds(const MachineInfo& tooling, const Vector2& bounds, const Vector2& orientedBounds) {
+  const auto area = (bounds.x + tooling.padding) * (bounds.y + tooling.padding);
+  const auto orientedArea = (orientedBounds.x + tooling.padding) * (orientedBounds.y + tooling.padding);
+  return orientedArea < area ? orientedBounds : bounds;
+}
+
+double ComputeCost(const MachineInfo& tooling, double materialArea, double cutTime) {
+  
+  return (materialArea * tooling.cost_per_sq_in) + (cutTime * tooling.cost_per_s);
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+struct CutSequence;
 struct Vector2;
 
 //Basic description of the parameters for a CNC machine
@@ -9,6 +10,24 @@ struct MachineInfo  {
   const double max_speed; //In inches per second
   const double cost_per_s; //In dollars per second
   const double cost_per_sq_in; //In dollars per square inch.
+  const double rapid_speed; //In inches per second, moving between contours without cutting
+  const double acceleration; //In inches per second squared; zero for the constant speed model
+  const double junction_deviation; //In inches, how far corners may be rounded off at speed
 };
 
-double ComputeCost(const MachineInfo& tooling, const Vector2& bounds, double cutTime);
\ No newline at end of file
+//Seconds to cut cutLength inches and make rapidLength inches of moves between cuts.
+double ComputeCutTime(const MachineInfo& tooling, double cutLength, double rapidLength);
+
+//With an acceleration set, cutting is timed over cuts with the kinematic
+//model in MotionPlanner.h and cutLength is unused; otherwise as above.
+double ComputeCutTime(const MachineInfo& tooling, const CutSequence& cuts, double cutLength, double rapidLength);
+
+double ComputeCost(const MachineInfo& tooling, const Vector2& bounds, double cutTime);
+
+//Whichever of the axis aligned bounds and the size of an oriented box (see
+//OrientedBounds.h) covers less material once padded.
+Vector2 ChargedBounds(const MachineInfo& tooling, const Vector2& bounds, const Vector2& orientedBounds);
+
+//Cost with the material charged by area directly, e.g. a part's share of
+//the sheets a nested job used rather than its own padded bounding box.
+double ComputeCost(const MachineInfo& tooling, double materialArea, double cutTime);
\ No newline at end of file
@@ -0,0 +1,44 @@
+#include "MappedFile.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string& filename) : m_data(nullptr), m_size(0) {
+  const int fd = open(filename.c_str(), O_RDONLY);
+  if(fd < 0)
+    throw std::runtime_error("Error opening " + filename + ": " + strerror(errno));
+
+  struct stat info;
+  if(fstat(fd, &info) != 0) {
+    const int err = errno;
+    close(fd);
+    throw std::runtime_error("Error reading " + filename + ": " + strerror(err));
+  }
+
+  m_size = static_cast<size_t>(info.st_size);
+
+  //mmap rejects zero length mappings; an empty file is simply an empty range.
+  if(m_size > 0) {
+    void* mapping = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(mapping == MAP_FAILED) {
+      const int err = errno;
+      close(fd);
+      throw std::runtime_error("Error mapping " + filename + ": " + strerror(err));
+    }
+    m_data = static_cast<const char*>(mapping);
+  }
+
+  //The mapping stays valid after the descriptor is closed.
+  close(fd);
+}
+
+MappedFile::~MappedFile() {
+  if(m_data)
+    munmap(const_cast<char*>(m_data), m_size);
+}
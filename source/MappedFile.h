@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+//Read-only memory mapping of a whole file, unmapped on destruction.
+class MappedFile {
+public:
+  explicit MappedFile(const std::string& filename);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const char* Data() const { return m_data; }
+  size_t Size() const { return m_size; }
+
+private:
+  const char* m_data;
+  size_t m_size;
+};
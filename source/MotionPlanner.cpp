@@ -0,0 +1,187 @@
+#include "MotionPlanner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+const double INFINITE = std::numeric_limits<double>::infinity();
+
+//One move, with the direction of travel where it starts and where it ends.
+struct Move {
+  double length;
+  double radius;
+  Vector2 startDirection, endDirection;
+};
+
+Vector2 Negated(const Vector2& v) {
+  return { -v.x, -v.y };
+}
+
+//Unit tangent, counter-clockwise, at a point on a circle around center.
+Vector2 Tangent(const Vector2& point, const Vector2& center) {
+  const auto offset = point - center;
+  return Vector2{ -offset.y, offset.x } / sqrt(Dot(offset, offset));
+}
+
+Move LineMove(const Vector2& from, const Vector2& to) {
+  const double length = Distance(from, to);
+  const auto direction = (to - from) / length;
+  return { length, INFINITE, direction, direction };
+}
+
+//The arc runs counter-clockwise from v0 to v1; backwards, it is cut from v1 to v0.
+Move ArcMove(const Vector2& v0, const Vector2& v1, const Vector2& center, bool backwards) {
+  const double r = Distance(center, v0);
+  const double a0 = atan2(v0.y - center.y, v0.x - center.x);
+  double a1 = atan2(v1.y - center.y, v1.x - center.x);
+  if(a1 <= a0)
+    a1 += 2*M_PI;
+
+  const auto start = Tangent(v0, center);
+  const auto end = Tangent(v1, center);
+  if(backwards)
+    return { (a1 - a0) * r, r, Negated(end), Negated(start) };
+  return { (a1 - a0) * r, r, start, end };
+}
+
+Move HalfEdgeMove(const IndexedPath& path, const PathTopology& topology, uint32_t halfEdge) {
+  const uint32_t edge = PathTopology::Edge(halfEdge);
+  if(!topology.IsArc(edge))
+    return LineMove(path.vertices[topology.Origin(path, halfEdge)], path.vertices[topology.Target(path, halfEdge)]);
+
+  const auto& arc = path.arcs[edge - topology.lineCount];
+  return ArcMove(path.vertices[arc.v0], path.vertices[arc.v1], arc.center, (halfEdge & 1) != 0);
+}
+
+//sin(a/2) / (1 - sin(a/2)), with sin(a/2) from the half angle identity:
+//the angle a at the junction is pi less the angle between the directions.
+double JunctionFactor(const Vector2& before, const Vector2& after) {
+  const double sinHalf = sqrt(std::max(0.0, 0.5 * (1 + Dot(before, after))));
+  return sinHalf < 1 ? sinHalf / (1 - sinHalf) : INFINITE;
+}
+
+//Appends one contour's moves, the first from a stop.
+class SequenceWriter {
+public:
+  explicit SequenceWriter(CutSequence& out) : m_out(out) {}
+
+  void StartContour() { m_first = true; }
+
+  void Add(const Move& move) {
+    if(!(move.length > 0))
+      return;
+    m_out.length.push_back(move.length);
+    m_out.radius.push_back(move.radius);
+    m_out.junction.push_back(m_first ? 0 : JunctionFactor(m_previous, move.startDirection));
+    m_previous = move.endDirection;
+    m_first = false;
+  }
+
+private:
+  CutSequence& m_out;
+  Vector2 m_previous = { 0, 0 };
+  bool m_first = true;
+};
+
+//Seconds to cover length, entering at the square root of startSquared and
+//leaving at that of endSquared: accelerate to the peak speed, cruise, brake.
+//The peak is where the two ramps meet, unless the limit cuts it off first.
+double MoveTime(double length, double startSquared, double endSquared, double limitSquared, double acceleration) {
+  const double peakSquared = std::min(limitSquared, (startSquared + endSquared) * 0.5 + acceleration * length);
+  const double peak = sqrt(peakSquared);
+  const double ramps = (2 * peakSquared - startSquared - endSquared) / (2 * acceleration);
+  const double cruise = std::max(0.0, length - ramps);
+  return (2 * peak - sqrt(startSquared) - sqrt(endSquared)) / acceleration + cruise / peak;
+}
+
+}
+
+void CutSequence::Clear() {
+  length.clear();
+  radius.clear();
+  junction.clear();
+}
+
+void MakeCutSequence(const IndexedPath& path, const PathTopology& topology, const RapidPlan& plan,
+                     CutSequence& out) {
+  out.Clear();
+  out.length.reserve(topology.contourHalfEdges.size());
+  out.radius.reserve(topology.contourHalfEdges.size());
+  out.junction.reserve(topology.contourHalfEdges.size());
+
+  SequenceWriter writer(out);
+  for(uint32_t c : plan.order) {
+    const uint32_t begin = topology.contourOffsets[c];
+    const uint32_t end = topology.contourOffsets[c + 1];
+    writer.StartContour();
+
+    //A closed contour goes once around its links from the entry vertex; an
+    //open chain follows them to its far end, on the twins when reversed.
+    if(topology.contourClosed[c]) {
+      uint32_t first = topology.contourHalfEdges[begin];
+      for(uint32_t i = begin; i < end; ++i) {
+        if(topology.Origin(path, topology.contourHalfEdges[i]) == plan.entry[c]) {
+          first = topology.contourHalfEdges[i];
+          break;
+        }
+      }
+      uint32_t halfEdge = first;
+      do {
+        writer.Add(HalfEdgeMove(path, topology, halfEdge));
+        halfEdge = topology.halfEdgeNext[halfEdge];
+      } while(halfEdge != first);
+    }
+    else {
+      uint32_t halfEdge = plan.reversed[c] ?
+        PathTopology::Twin(topology.contourHalfEdges[end - 1]) : topology.contourHalfEdges[begin];
+      for(; halfEdge != PathTopology::NO_HALF_EDGE; halfEdge = topology.halfEdgeNext[halfEdge])
+        writer.Add(HalfEdgeMove(path, topology, halfEdge));
+    }
+  }
+}
+
+double PlanCutSequence(const IndexedPath& path, CutSequence& out) {
+  const auto topology = AnalyzeTopology(path);
+  const auto plan = PlanRapidMoves(path, topology, DefaultRapidOptions());
+  MakeCutSequence(path, topology, plan, out);
+  return plan.rapidDistance;
+}
+
+double ComputeKinematicTime(const CutSequence& cuts, double maxSpeed, double acceleration,
+                            double junctionDeviation) {
+  const size_t count = cuts.Size();
+  const double maxSquared = maxSpeed * maxSpeed;
+
+  //Squared speed limits: along a move, where arcs keep the centripetal
+  //acceleration in bounds, and at the junction where it starts.
+  const auto moveLimit = [&](size_t i) {
+    return std::min(maxSquared, acceleration * cuts.radius[i]);
+  };
+  const auto junctionLimit = [&](size_t i) {
+    return cuts.junction[i] < INFINITE ? acceleration * junctionDeviation * cuts.junction[i] : INFINITE;
+  };
+
+  //Backward pass: the fastest each move can be entered and still brake to
+  //whatever follows, ending at a stop after the last move.
+  std::vector<double> entrySquared(count + 1);
+  entrySquared[count] = 0;
+  for(size_t i = count; i-- > 0;) {
+    double limit = std::min(moveLimit(i), junctionLimit(i));
+    if(i > 0)
+      limit = std::min(limit, moveLimit(i - 1));
+    entrySquared[i] = std::min(limit, entrySquared[i + 1] + 2 * acceleration * cuts.length[i]);
+  }
+
+  //Forward pass: accelerate out of each junction as far as the move allows.
+  double time = 0;
+  double speedSquared = 0;
+  for(size_t i = 0; i < count; ++i) {
+    const double startSquared = std::min(speedSquared, entrySquared[i]);
+    const double endSquared = std::min(entrySquared[i + 1], startSquared + 2 * acceleration * cuts.length[i]);
+    time += MoveTime(cuts.length[i], startSquared, endSquared, moveLimit(i), acceleration);
+    speedSquared = endSquared;
+  }
+  return time;
+}
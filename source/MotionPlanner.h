@@ -0,0 +1,52 @@
+#pragma once
+
+#include "IndexedPath.h"
+#include "PathTopology.h"
+#include "RapidSequencing.h"
+
+#include <cstddef>
+#include <vector>
+
+//Kinematic cut time: the cutting moves are laid out in the order the machine
+//makes them, then timed with a trapezoidal velocity profile, the way CNC
+//firmware plans its motion.
+//
+//The head accelerates and brakes at a fixed rate, stops at the start and end
+//of every contour, slows on arcs so the centripetal acceleration stays within
+//the limit, and takes each corner no faster than the junction deviation rule
+//allows: the speed at which a circle of that deviation, tangent to both
+//moves, could be followed at full acceleration. Planning is a backward pass
+//finding how fast each junction can be entered and still stop in time, then
+//a forward pass timing each move, so it is linear in the number of moves.
+
+//The cutting moves of a path in order, as parallel arrays with one entry per
+//move. Edges of zero length are dropped.
+struct CutSequence {
+  std::vector<double> length; //In inches, along the move
+  std::vector<double> radius; //Of an arc; infinity for a line
+
+  //sin(a/2) / (1 - sin(a/2)) for the angle a the path makes where the
+  //previous move meets this one: pi, and an infinite factor, straight on;
+  //zero for a reversal. Zero at the start of a contour too, where the head
+  //pierces from a stop.
+  std::vector<double> junction;
+
+  size_t Size() const { return length.size(); }
+  void Clear();
+};
+
+//Walks every contour of path in the plan's order: closed contours from their
+//entry vertex, open chains end to end in the planned direction.
+void MakeCutSequence(const IndexedPath& path, const PathTopology& topology, const RapidPlan& plan,
+                     CutSequence& out);
+
+//Plans the rapid moves of path under the default options, as
+//PlanRapidDistance does, and lays out its cutting moves in that order.
+//Returns the rapid distance.
+double PlanCutSequence(const IndexedPath& path, CutSequence& out);
+
+//Seconds to make every move of cuts at up to maxSpeed inches per second,
+//accelerating at acceleration inches per second squared, with corners
+//limited by junctionDeviation inches. Acceleration must be positive.
+double ComputeKinematicTime(const CutSequence& cuts, double maxSpeed, double acceleration,
+                            double junctionDeviation);
@@ -0,0 +1,179 @@
+#include "Nesting.h"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+class Skyline {
+public:
+  explicit Skyline(const Vector2& sheet) : m_sheet(sheet) {
+    m_segments.push_back({ 0, 0, sheet.x });
+  }
+
+  //Finds the lowest, then leftmost, spot for a size.x by size.y rectangle.
+  bool Find(const Vector2& size, size_t& index, Vector2& position) const {
+    //Nothing can sit lower than the lowest segment; this rejects full sheets quickly.
+    if(m_floor + size.y > m_sheet.y || size.x > m_sheet.x)
+      return false;
+
+    bool found = false;
+    for(size_t i = 0; i < m_segments.size(); ++i) {
+      const double left = m_segments[i].x;
+      if(left + size.x > m_sheet.x)
+        break;
+
+      //The rectangle rests on the highest segment it spans.
+      double top = 0;
+      double remaining = size.x;
+      for(size_t j = i; remaining > 0 && j < m_segments.size(); ++j) {
+        top = std::max(top, m_segments[j].y);
+        remaining -= m_segments[j].width;
+      }
+
+      if(top + size.y > m_sheet.y)
+        continue;
+      if(!found || top < position.y) {
+        found = true;
+        index = i;
+        position = { left, top };
+      }
+    }
+    return found;
+  }
+
+  void Place(size_t index, const Vector2& position, const Vector2& size) {
+    const double right = position.x + size.x;
+
+    //Drop or trim the segments now underneath the rectangle.
+    size_t end = index;
+    while(end < m_segments.size() && m_segments[end].x < right) {
+      auto& segment = m_segments[end];
+      const double segmentRight = segment.x + segment.width;
+      if(segmentRight > right) {
+        segment.width = segmentRight - right;
+        segment.x = right;
+        break;
+      }
+      ++end;
+    }
+    m_segments.erase(m_segments.begin() + index, m_segments.begin() + end);
+    m_segments.insert(m_segments.begin() + index, { position.x, position.y + size.y, size.x });
+    m_used.x = std::max(m_used.x, right);
+    m_used.y = std::max(m_used.y, position.y + size.y);
+
+    //Merge level neighbours so the outline stays short.
+    if(index + 1 < m_segments.size() && m_segments[index + 1].y == m_segments[index].y) {
+      m_segments[index].width += m_segments[index + 1].width;
+      m_segments.erase(m_segments.begin() + index + 1);
+    }
+    if(index > 0 && m_segments[index - 1].y == m_segments[index].y) {
+      m_segments[index - 1].width += m_segments[index].width;
+      m_segments.erase(m_segments.begin() + index);
+    }
+
+    m_floor = m_segments[0].y;
+    for(const auto& segment : m_segments)
+      m_floor = std::min(m_floor, segment.y);
+  }
+
+  Vector2 Used() const { return m_used; }
+
+private:
+  struct Segment {
+    double x, y, width;
+  };
+
+  Vector2 m_sheet;
+  std::vector<Segment> m_segments;
+  Vector2 m_used = { 0, 0 };
+  double m_floor = 0;
+};
+
+}
+
+bool FitsOnSheet(const Vector2& part, const NestOptions& options) {
+  const auto& sheet = options.sheet;
+  return (part.x <= sheet.x && part.y <= sheet.y) ||
+    (options.allowRotation && part.y <= sheet.x && part.x <= sheet.y);
+}
+
+double NestResult::ChargedArea(const Vector2& sheet) const {
+  if(sheetCount == 0)
+    return 0;
+  return (sheetCount - 1) * sheet.x * sheet.y + lastSheetUsed.x * lastSheetUsed.y;
+}
+
+double NestResult::Utilization(const Vector2& sheet) const {
+  const double charged = ChargedArea(sheet);
+  return charged > 0 ? partArea / charged : 0;
+}
+
+NestResult NestParts(const std::vector<Vector2>& parts, const NestOptions& options) {
+  const Vector2 sheet = options.sheet;
+  const auto rotate = [](const Vector2& v) { return Vector2{ v.y, v.x }; };
+
+  NestResult result;
+  result.placements.resize(parts.size());
+  result.sheetCount = 0;
+  result.lastSheetUsed = { 0, 0 };
+  result.partArea = 0;
+
+  for(size_t i = 0; i < parts.size(); ++i) {
+    if(!(parts[i].x >= 0 && parts[i].y >= 0))
+      throw std::runtime_error("Part " + std::to_string(i) + " has an invalid size");
+    if(!FitsOnSheet(parts[i], options))
+      throw std::runtime_error("Part " + std::to_string(i) + " does not fit on a " +
+                               std::to_string(sheet.x) + " x " + std::to_string(sheet.y) + " sheet");
+    result.partArea += parts[i].x * parts[i].y;
+  }
+
+  //Tallest first; with rotation a part can stand on either side, so its
+  //longer side decides.
+  std::vector<size_t> order(parts.size());
+  std::iota(order.begin(), order.end(), size_t(0));
+  const auto key = [&](size_t i) {
+    return options.allowRotation ? std::max(parts[i].x, parts[i].y) : parts[i].y;
+  };
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return key(a) > key(b); });
+
+  std::vector<Skyline> sheets;
+  for(const size_t part : order) {
+    bool placed = false;
+    for(size_t s = 0; s <= sheets.size() && !placed; ++s) {
+      if(s == sheets.size())
+        sheets.emplace_back(sheet);
+
+      size_t index = 0;
+      Vector2 position = { 0, 0 };
+      bool rotated = false;
+      bool found = sheets[s].Find(parts[part], index, position);
+
+      if(options.allowRotation) {
+        size_t rotatedIndex = 0;
+        Vector2 rotatedPosition = { 0, 0 };
+        if(sheets[s].Find(rotate(parts[part]), rotatedIndex, rotatedPosition) &&
+           (!found || rotatedPosition.y < position.y ||
+            (rotatedPosition.y == position.y && rotatedPosition.x < position.x))) {
+          found = true;
+          rotated = true;
+          index = rotatedIndex;
+          position = rotatedPosition;
+        }
+      }
+
+      if(found) {
+        sheets[s].Place(index, position, rotated ? rotate(parts[part]) : parts[part]);
+        result.placements[part] = { static_cast<uint32_t>(s), position, rotated };
+        placed = true;
+      }
+    }
+  }
+
+  result.sheetCount = sheets.size();
+  if(!sheets.empty())
+    result.lastSheetUsed = sheets.back().Used();
+  return result;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Vector2.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//Packs part rectangles (padded bounding boxes) onto identical stock sheets.
+//
+//Each open sheet keeps a skyline: the upper outline of everything placed
+//on it, as segments ordered by x. A part is tried at the left end of every
+//segment and goes where it sits lowest, then furthest left. Parts are
+//placed tallest first, on the first open sheet with room, and a new sheet
+//is opened when none has any.
+
+struct NestOptions {
+  Vector2 sheet; //Stock sheet width and height, in inches
+  bool allowRotation; //Parts may be turned 90 degrees
+};
+
+struct NestPlacement {
+  uint32_t sheet;
+  Vector2 position; //Lower left corner on the sheet
+  bool rotated;
+};
+
+struct NestResult {
+  std::vector<NestPlacement> placements; //One per input part, in input order
+  size_t sheetCount;
+  Vector2 lastSheetUsed; //Bounding box of the parts on the last sheet
+  double partArea; //Total area of the parts themselves
+
+  //Stock consumed by the job: every sheet but the last in full, plus the
+  //bounding box of the parts on the last one. The rest of it is offcut
+  //that goes back on the rack.
+  double ChargedArea(const Vector2& sheet) const;
+
+  double Utilization(const Vector2& sheet) const;
+};
+
+//Whether the part fits on an empty sheet, turned if rotation is allowed.
+bool FitsOnSheet(const Vector2& part, const NestOptions& options);
+
+//Throws a runtime_error if a part cannot fit on an empty sheet.
+NestResult NestParts(const std::vector<Vector2>& parts, const NestOptions& options);
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+//Locale independent, allocation free parsing of json numbers.
+//
+//Doubles are correctly rounded: exactly representable cases take Clinger's
+//fast path, the rest use the Eisel-Lemire algorithm on a 128 bit power of
+//five table. The rare inputs it can't decide (more than 19 significant
+//digits sitting on a rounding boundary) fall back to strtod in the "C"
+//locale.
+
+//Parses a json number at [begin, end). Returns one past its last byte, or
+//nullptr if the text there is not a json number.
+const char* ParseJsonNumber(const char* begin, const char* end, double& value);
+
+//Parses a non-negative integer written without sign, leading zeros,
+//fraction or exponent that fits in 64 bits. Returns nullptr, without
+//touching value, for anything else - including numbers that merely start
+//with such an integer, like 12.5.
+const char* ParseJsonInteger(const char* begin, const char* end, uint64_t& value);
@@ -0,0 +1,270 @@
+#include "OrientedBounds.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+std::atomic<bool> g_orientedPricing(false);
+
+//Positive when a, b, c turn counter-clockwise.
+double Cross(const Vector2& a, const Vector2& b, const Vector2& c) {
+  return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+
+bool SamePoint(const Vector2& a, const Vector2& b) {
+  return a.x == b.x && a.y == b.y;
+}
+
+//Polygon of the points of a shape furthest in the eight directions at
+//multiples of 45 degrees, in counter-clockwise order. It lies inside the
+//shape's hull, so nothing strictly inside it can be on the hull. Discarding
+//that first leaves a small fraction of most parts' points to sort. The
+//diagonals keep it from collapsing to a triangle when the extremes along an
+//axis tie, as they do all along the sides of a rectangular part.
+class ExtremePolygon {
+public:
+  void Add(const Vector2& p) {
+    if(m_count++ == 0) {
+      for(size_t k = 0; k < 8; ++k) {
+        m_extremes[k] = p;
+        m_reach[k] = Reach(k, p);
+      }
+      return;
+    }
+    for(size_t k = 0; k < 8; ++k) {
+      const double reach = Reach(k, p);
+      if(reach > m_reach[k]) {
+        m_extremes[k] = p;
+        m_reach[k] = reach;
+      }
+    }
+  }
+
+  //Merges repeated corners. False when they enclose nothing.
+  bool Build() {
+    m_corners = 0;
+    for(size_t k = 0; k < 8 && m_count > 0; ++k) {
+      if(m_corners == 0 || !SamePoint(m_polygon[m_corners - 1], m_extremes[k]))
+        m_polygon[m_corners++] = m_extremes[k];
+    }
+    if(m_corners > 1 && SamePoint(m_polygon[m_corners - 1], m_polygon[0]))
+      --m_corners;
+    if(m_corners < 3)
+      m_corners = 0;
+    return m_corners > 0;
+  }
+
+  //Whether the disc of radius margin around p is strictly inside. Only
+  //valid after Build.
+  bool Inside(const Vector2& p, double margin) const {
+    if(m_corners == 0)
+      return false;
+    for(size_t k = 0; k < m_corners; ++k) {
+      const auto& a = m_polygon[k];
+      const auto& b = m_polygon[(k + 1) % m_corners];
+      if(!(Cross(a, b, p) > margin * Distance(a, b)))
+        return false;
+    }
+    return true;
+  }
+
+private:
+  //Distance along the k-th direction counter-clockwise from -x, unscaled.
+  static double Reach(size_t k, const Vector2& p) {
+    switch(k) {
+      case 0: return -p.x;
+      case 1: return -p.x - p.y;
+      case 2: return -p.y;
+      case 3: return p.x - p.y;
+      case 4: return p.x;
+      case 5: return p.x + p.y;
+      case 6: return p.y;
+      default: return p.y - p.x;
+    }
+  }
+
+  Vector2 m_extremes[8];
+  double m_reach[8];
+  Vector2 m_polygon[8];
+  size_t m_count = 0;
+  size_t m_corners = 0;
+};
+
+void DiscardInterior(std::vector<Vector2>& points) {
+  if(points.size() < 8)
+    return;
+
+  ExtremePolygon polygon;
+  for(const auto& p : points)
+    polygon.Add(p);
+  if(!polygon.Build())
+    return;
+  points.erase(std::remove_if(points.begin(), points.end(),
+                              [&](const Vector2& p) { return polygon.Inside(p, 0); }), points.end());
+}
+
+//Angles of the counter-clockwise arc from v0 to v1 around center.
+void ArcAngles(const Vector2& v0, const Vector2& v1, const Vector2& center, double& a0, double& a1) {
+  a0 = atan2(v0.y - center.y, v0.x - center.x);
+  a1 = atan2(v1.y - center.y, v1.x - center.x);
+  if(a1 <= a0)
+    a1 += 2*M_PI;
+}
+
+//Appends the corners of a polygon circumscribing the counter-clockwise arc
+//from v0 to v1, along with its ends. Each corner is where the tangents at
+//either end of a piece of the arc meet, so the polygon holds the arc.
+void AddArcPoints(const Vector2& v0, const Vector2& v1, const Vector2& center, std::vector<Vector2>& points) {
+  points.push_back(v0);
+  points.push_back(v1);
+
+  const double r = Distance(center, v0);
+  if(!(r > 0))
+    return;
+  double a0, a1;
+  ArcAngles(v0, v1, center, a0, a1);
+
+  //A piece of angle step bulges r / cos(step / 2) - r past the arc; pieces
+  //are kept to a quarter turn so the corners stay close.
+  const double maxStep = std::min(M_PI_2, 2 * acos(r / (r + ARC_TOLERANCE)));
+  const size_t pieces = static_cast<size_t>(std::ceil((a1 - a0) / maxStep));
+  const double step = (a1 - a0) / pieces;
+  const double cornerRadius = r / cos(step / 2);
+  for(size_t k = 0; k < pieces; ++k) {
+    const double angle = a0 + (k + 0.5) * step;
+    points.push_back({ center.x + cornerRadius * cos(angle), center.y + cornerRadius * sin(angle) });
+  }
+}
+
+}
+
+void ConvexHull(std::vector<Vector2>& points, std::vector<Vector2>& hull) {
+  hull.clear();
+  DiscardInterior(points);
+  std::sort(points.begin(), points.end(), [](const Vector2& a, const Vector2& b) {
+    return a.x < b.x || (a.x == b.x && a.y < b.y);
+  });
+  points.erase(std::unique(points.begin(), points.end(), SamePoint), points.end());
+  if(points.size() < 3) {
+    hull = points;
+    return;
+  }
+
+  //Lower chain left to right, then the upper chain back, turning left only.
+  hull.resize(2 * points.size());
+  size_t count = 0;
+  for(size_t i = 0; i < points.size(); ++i) {
+    while(count >= 2 && Cross(hull[count - 2], hull[count - 1], points[i]) <= 0)
+      --count;
+    hull[count++] = points[i];
+  }
+  const size_t lower = count + 1;
+  for(size_t i = points.size() - 1; i-- > 0;) {
+    while(count >= lower && Cross(hull[count - 2], hull[count - 1], points[i]) <= 0)
+      --count;
+    hull[count++] = points[i];
+  }
+
+  //The last point is the first again.
+  hull.resize(count - 1);
+}
+
+OrientedBox MinimumAreaBox(const std::vector<Vector2>& hull) {
+  const size_t n = hull.size();
+  if(n == 0)
+    return { { 1, 0 }, { 0, 0 }, { 0, 0 } };
+  if(n == 1)
+    return { { 1, 0 }, { 0, 0 }, hull[0] };
+  if(n == 2) {
+    const double length = Distance(hull[0], hull[1]);
+    return { (hull[1] - hull[0]) / length, { length, 0 }, hull[0] };
+  }
+
+  //Calipers on the far side along the edge, the far side across it and the
+  //near side along it. Each only ever moves forwards around the hull.
+  size_t right = 1, top = 1, left = 1;
+  OrientedBox best = { { 1, 0 }, { 0, 0 }, { 0, 0 } };
+  double bestArea = std::numeric_limits<double>::infinity();
+  for(size_t i = 0; i < n; ++i) {
+    const auto& origin = hull[i];
+    const auto axis = (hull[(i + 1) % n] - origin) / Distance(origin, hull[(i + 1) % n]);
+    const Vector2 normal = { -axis.y, axis.x };
+    const auto along = [&](size_t j) { return Dot(hull[j] - origin, axis); };
+    const auto across = [&](size_t j) { return Dot(hull[j] - origin, normal); };
+
+    while(along((right + 1) % n) > along(right))
+      right = (right + 1) % n;
+    if(i == 0)
+      top = right;
+    while(across((top + 1) % n) > across(top))
+      top = (top + 1) % n;
+    if(i == 0)
+      left = top;
+    while(along((left + 1) % n) < along(left))
+      left = (left + 1) % n;
+
+    const double width = along(right) - along(left);
+    const double height = across(top);
+    if(width * height < bestArea) {
+      bestArea = width * height;
+      const double start = along(left);
+      best = { axis, { width, height }, { origin.x + axis.x * start, origin.y + axis.y * start } };
+    }
+  }
+  return best;
+}
+
+OrientedBox ComputeOrientedBounds(const IndexedPath& path) {
+  //Each vertex an edge uses, once.
+  std::vector<uint8_t> used(path.vertices.size(), 0);
+  for(const auto& line : path.lines)
+    used[line.v0] = used[line.v1] = 1;
+  for(const auto& arc : path.arcs)
+    used[arc.v0] = used[arc.v1] = 1;
+
+  //The extremes include the points where arcs pass the eight directions.
+  ExtremePolygon polygon;
+  for(size_t v = 0; v < path.vertices.size(); ++v) {
+    if(used[v])
+      polygon.Add(path.vertices[v]);
+  }
+  for(const auto& arc : path.arcs) {
+    const auto& v0 = path.vertices[arc.v0];
+    const double r = Distance(arc.center, v0);
+    double a0, a1;
+    ArcAngles(v0, path.vertices[arc.v1], arc.center, a0, a1);
+    for(int dir = -4; dir <= 12; ++dir) {
+      const double theta = M_PI_4 * dir;
+      if(theta >= a0 && theta <= a1)
+        polygon.Add({ arc.center.x + r * cos(theta), arc.center.y + r * sin(theta) });
+    }
+  }
+  polygon.Build();
+
+  //Arcs whose whole circle is inside the polygon are never sampled.
+  std::vector<Vector2> points;
+  for(size_t v = 0; v < path.vertices.size(); ++v) {
+    if(used[v] && !polygon.Inside(path.vertices[v], 0))
+      points.push_back(path.vertices[v]);
+  }
+  for(const auto& arc : path.arcs) {
+    const auto& v0 = path.vertices[arc.v0];
+    if(!polygon.Inside(arc.center, Distance(arc.center, v0)))
+      AddArcPoints(v0, path.vertices[arc.v1], arc.center, points);
+  }
+
+  std::vector<Vector2> hull;
+  ConvexHull(points, hull);
+  return MinimumAreaBox(hull);
+}
+
+void SetOrientedPricing(bool enabled) {
+  g_orientedPricing = enabled;
+}
+
+bool OrientedPricing() {
+  return g_orientedPricing.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "IndexedPath.h"
+#include "Vector2.h"
+
+#include <vector>
+
+//Minimum area oriented bounding box of a path, for charging material on
+//parts drawn at an angle to the axes.
+//
+//The convex hull of the path is built with Andrew's monotone chain, after an
+//O(n) pass drops the points inside the polygon of the extreme points in eight
+//directions, and the rectangle is then found with rotating calipers. The minimum area
+//rectangle always has a side along a hull edge, so the calipers only compare
+//the hull edge directions. Overall O(n log n) in the number of vertices.
+//
+//Arcs are covered by the corners of a polygon circumscribing them, with
+//enough corners that it stays within ARC_TOLERANCE of the arc; arcs whose
+//circle is inside that extreme point polygon are skipped. The box can be that
+//much larger than the exact one, but never smaller.
+
+const double ARC_TOLERANCE = 1e-4; //In inches
+
+struct OrientedBox {
+  Vector2 axis; //Unit direction of the box's width
+  Vector2 size; //Width along axis, height along its left normal
+  Vector2 corner; //Where the width and height are measured from
+};
+
+//Counter-clockwise convex hull of points, with no collinear points. Reorders points.
+void ConvexHull(std::vector<Vector2>& points, std::vector<Vector2>& hull);
+
+//Minimum area rectangle around a counter-clockwise convex hull.
+OrientedBox MinimumAreaBox(const std::vector<Vector2>& hull);
+
+//The box around every edge of path; all zero for a path without edges.
+OrientedBox ComputeOrientedBounds(const IndexedPath& path);
+
+//Selects charging material by the oriented box where it is cheaper than the
+//axis aligned one (cadquote --oriented-bounds). Off by default.
+void SetOrientedPricing(bool enabled);
+bool OrientedPricing();
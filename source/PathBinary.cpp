@@ -0,0 +1,119 @@
+#include "PathBinary.h"
+#include "ToolPath.h"
+
+#include <cstring>
+#include <stdexcept>
+
+static_assert(sizeof(Vector2) == 16, "binary path format expects packed Vector2");
+static_assert(sizeof(IndexedPath::Line) == 8, "binary path format expects packed lines");
+static_assert(sizeof(IndexedPath::Arc) == 24, "binary path format expects packed arcs");
+static_assert(sizeof(PathFileHeader) == 56, "binary path header layout changed");
+
+namespace {
+
+const char PATH_FILE_MAGIC[4] = { 'C', 'Q', 'T', 'P' };
+
+uint64_t AlignTo8(uint64_t offset) {
+  return (offset + 7) & ~uint64_t(7);
+}
+
+template<typename T>
+const T* Section(const char* data, size_t size, uint64_t offset, uint64_t count, const char* name) {
+  if(offset % 8 != 0 || offset > size || count > (size - offset) / sizeof(T))
+    throw std::runtime_error(std::string("Error reading binary path: ") + name + " section out of bounds");
+  return reinterpret_cast<const T*>(data + offset);
+}
+
+void CheckIndex(uint32_t index, size_t vertexCount) {
+  if(index >= vertexCount)
+    throw std::runtime_error("Error reading binary path: vertex index " + std::to_string(index) + " out of range");
+}
+
+}
+
+bool IsBinaryPath(const char* data, size_t size) {
+  return size >= sizeof(PATH_FILE_MAGIC) && memcmp(data, PATH_FILE_MAGIC, sizeof(PATH_FILE_MAGIC)) == 0;
+}
+
+BinaryPathView ParseBinaryPath(const char* data, size_t size) {
+  if(size < sizeof(PathFileHeader) || !IsBinaryPath(data, size))
+    throw std::runtime_error("Error reading binary path: missing header");
+
+  PathFileHeader header;
+  memcpy(&header, data, sizeof(header));
+  if(header.version != PATH_FILE_VERSION)
+    throw std::runtime_error("Error reading binary path: unsupported version " + std::to_string(header.version));
+
+  BinaryPathView view;
+  view.vertices = Section<Vector2>(data, size, header.vertexOffset, header.vertexCount, "vertex");
+  view.vertexCount = header.vertexCount;
+  view.lines = Section<IndexedPath::Line>(data, size, header.lineOffset, header.lineCount, "line");
+  view.lineCount = header.lineCount;
+  view.arcs = Section<IndexedPath::Arc>(data, size, header.arcOffset, header.arcCount, "arc");
+  view.arcCount = header.arcCount;
+
+  for(size_t i = 0; i < view.lineCount; ++i) {
+    CheckIndex(view.lines[i].v0, view.vertexCount);
+    CheckIndex(view.lines[i].v1, view.vertexCount);
+  }
+  for(size_t i = 0; i < view.arcCount; ++i) {
+    CheckIndex(view.arcs[i].v0, view.vertexCount);
+    CheckIndex(view.arcs[i].v1, view.vertexCount);
+  }
+
+  return view;
+}
+
+void WriteBinaryPath(const IndexedPath& path, std::ostream& out) {
+  PathFileHeader header;
+  memcpy(header.magic, PATH_FILE_MAGIC, sizeof(header.magic));
+  header.version = PATH_FILE_VERSION;
+  header.vertexCount = path.vertices.size();
+  header.lineCount = path.lines.size();
+  header.arcCount = path.arcs.size();
+  header.vertexOffset = AlignTo8(sizeof(PathFileHeader));
+  header.lineOffset = AlignTo8(header.vertexOffset + header.vertexCount * sizeof(Vector2));
+  header.arcOffset = AlignTo8(header.lineOffset + header.lineCount * sizeof(IndexedPath::Line));
+
+  const char padding[8] = {};
+  uint64_t written = 0;
+  auto writeSection = [&](uint64_t offset, const void* bytes, uint64_t length) {
+    out.write(padding, offset - written);
+    out.write(static_cast<const char*>(bytes), length);
+    written = offset + length;
+  };
+
+  writeSection(0, &header, sizeof(header));
+  writeSection(header.vertexOffset, path.vertices.data(), header.vertexCount * sizeof(Vector2));
+  writeSection(header.lineOffset, path.lines.data(), header.lineCount * sizeof(IndexedPath::Line));
+  writeSection(header.arcOffset, path.arcs.data(), header.arcCount * sizeof(IndexedPath::Arc));
+
+  if(!out)
+    throw std::runtime_error("Error writing binary path");
+}
+
+ToolPath MakeToolPath(const BinaryPathView& view) {
+  ToolPath toolPath;
+  toolPath.Reserve(view.lineCount, view.arcCount);
+
+  for(size_t i = 0; i < view.lineCount; ++i) {
+    const auto& line = view.lines[i];
+    toolPath.AddLineSegment(view.vertices[line.v0], view.vertices[line.v1]);
+  }
+
+  toolPath.AddCircularArcs(view.vertices, view.arcs, view.arcCount);
+
+  return toolPath;
+}
+
+IndexedPath MakeIndexedPath(const BinaryPathView& view) {
+  IndexedPath path;
+  MakeIndexedPath(view, path);
+  return path;
+}
+
+void MakeIndexedPath(const BinaryPathView& view, IndexedPath& out) {
+  out.vertices.assign(view.vertices, view.vertices + view.vertexCount);
+  out.lines.assign(view.lines, view.lines + view.lineCount);
+  out.arcs.assign(view.arcs, view.arcs + view.arcCount);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "IndexedPath.h"
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+class ToolPath;
+
+//Compact binary tool path format, laid out so a mapped file can be used in place:
+//
+//  PathFileHeader
+//  Vector2           vertices[vertexCount]
+//  IndexedPath::Line lines[lineCount]
+//  IndexedPath::Arc  arcs[arcCount]
+//
+//Sections start at 8 byte aligned offsets recorded in the header. Values are
+//stored little-endian; a big-endian reader sees an unknown version and rejects
+//the file.
+struct PathFileHeader {
+  char magic[4]; //"CQTP"
+  uint32_t version;
+  uint64_t vertexCount;
+  uint64_t lineCount;
+  uint64_t arcCount;
+  uint64_t vertexOffset;
+  uint64_t lineOffset;
+  uint64_t arcOffset;
+};
+
+const uint32_t PATH_FILE_VERSION = 1;
+
+//Validated, zero-copy view over a binary path held in memory.
+//Only valid while the underlying bytes are.
+struct BinaryPathView {
+  const Vector2* vertices;
+  size_t vertexCount;
+  const IndexedPath::Line* lines;
+  size_t lineCount;
+  const IndexedPath::Arc* arcs;
+  size_t arcCount;
+};
+
+bool IsBinaryPath(const char* data, size_t size);
+
+//Checks the header, section bounds and every vertex index, throwing on
+//malformed input. data must be 8 byte aligned.
+BinaryPathView ParseBinaryPath(const char* data, size_t size);
+
+void WriteBinaryPath(const IndexedPath& path, std::ostream& out);
+
+ToolPath MakeToolPath(const BinaryPathView& view);
+IndexedPath MakeIndexedPath(const BinaryPathView& view);
+void MakeIndexedPath(const BinaryPathView& view, IndexedPath& out);
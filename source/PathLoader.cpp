@@ -0,0 +1,412 @@
+#include "PathLoader.h"
+#include "Arena.h"
+#include "JsonCursor.h"
+#include "MappedFile.h"
+#include "PathBinary.h"
+#include "ThreadPool.h"
+#include "VertexIdTable.h"
+
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+
+//Everything the loader keeps while the document is being read.
+struct PathLoadState {
+  std::vector<Vector2> positions;
+  VertexIdTable ids;
+
+  //Edges can't be resolved until all vertices are known, so they are kept
+  //as id references until the end of the document.
+  struct PendingEdge {
+    VertexIdTable::Key v0, v1;
+    VertexIdTable::Key clockwiseFrom;
+    Vector2 center;
+    bool isArc;
+  };
+  typedef std::vector<PendingEdge, ArenaAllocator<PendingEdge>> EdgeList;
+
+  //Per document scratch lives in the arena and is dropped in one Reset.
+  MonotonicArena arena;
+  EdgeList edges;
+
+  PathLoadState() : edges(ArenaAllocator<PendingEdge>(arena)) {}
+
+  void Reset() {
+    positions.clear();
+    ids.Clear();
+    EdgeList(edges.get_allocator()).swap(edges);
+    arena.Reset();
+  }
+};
+
+namespace {
+
+typedef PathLoadState LoadState;
+
+//Below this, splitting and merging costs more than parsing serially.
+const size_t PARALLEL_LOAD_MIN_BYTES = 16 * 1024 * 1024;
+
+void RequireField(const JsonCursor& cursor, size_t objectOffset, bool found, const char* name) {
+  if(!found)
+    cursor.FailAt(objectOffset, std::string("Requred field ") + name + " not found");
+}
+
+//Ids are written as numbers in edge references and as strings in object
+//keys; both spellings map to the same key.
+VertexIdTable::Key ParseId(JsonCursor& cursor, VertexIdTable& ids) {
+  if(cursor.Peek() == '"') {
+    std::string scratch;
+    const auto id = cursor.ReadString(scratch);
+    return ids.KeyFromString(id.data, id.size);
+  }
+  uint64_t id;
+  if(cursor.TryReadInteger(id))
+    return ids.KeyFromInteger(id);
+  return ids.KeyFromNumber(cursor.ReadNumber());
+}
+
+Vector2 ParsePosition(JsonCursor& cursor) {
+  const size_t offset = cursor.Offset();
+  Vector2 position = {0,0};
+  bool hasX = false;
+  bool hasY = false;
+  cursor.ParseObject([&](const JsonString& key) {
+    if(key == "X") {
+      hasX = true;
+      position.x = cursor.ReadNumber();
+    }
+    else if(key == "Y") {
+      hasY = true;
+      position.y = cursor.ReadNumber();
+    }
+    else
+      cursor.SkipValue();
+  });
+  RequireField(cursor, offset, hasX, "X");
+  RequireField(cursor, offset, hasY, "Y");
+  return position;
+}
+
+Vector2 ParseVertex(JsonCursor& cursor) {
+  const size_t offset = cursor.Offset();
+  Vector2 position = {0,0};
+  bool hasPosition = false;
+  cursor.ParseObject([&](const JsonString& key) {
+    if(key == "Position") {
+      hasPosition = true;
+      position = ParsePosition(cursor);
+    }
+    else
+      cursor.SkipValue();
+  });
+  RequireField(cursor, offset, hasPosition, "Position");
+  return position;
+}
+
+void ParseVertices(JsonCursor& cursor, LoadState& state) {
+  cursor.ParseObject([&](const JsonString& key) {
+    //Intern the id before reading the body, which invalidates key.
+    const auto id = state.ids.KeyFromString(key.data, key.size);
+    const auto position = ParseVertex(cursor);
+    state.ids.Define(id, static_cast<uint32_t>(state.positions.size()));
+    state.positions.push_back(position);
+  });
+}
+
+void ParseEdge(JsonCursor& cursor, VertexIdTable& ids, LoadState::PendingEdge& edge) {
+  const size_t offset = cursor.Offset();
+  std::string typeScratch;
+  JsonString type = { nullptr, 0 };
+  bool hasType = false;
+  bool hasVertices = false;
+  bool hasCenter = false;
+  bool hasClockwiseFrom = false;
+
+  cursor.ParseObject([&](const JsonString& key) {
+    if(key == "Type") {
+      hasType = true;
+      type = cursor.ReadString(typeScratch);
+    }
+    else if(key == "Vertices") {
+      hasVertices = true;
+      const size_t count = cursor.ParseArray([&](size_t index) {
+        if(index == 0)
+          edge.v0 = ParseId(cursor, ids);
+        else if(index == 1)
+          edge.v1 = ParseId(cursor, ids);
+        else
+          cursor.SkipValue();
+      });
+      if(count < 2)
+        cursor.Fail("Edge has fewer than 2 Vertices");
+    }
+    else if(key == "Center") {
+      hasCenter = true;
+      edge.center = ParsePosition(cursor);
+    }
+    else if(key == "ClockwiseFrom") {
+      hasClockwiseFrom = true;
+      edge.clockwiseFrom = ParseId(cursor, ids);
+    }
+    else
+      cursor.SkipValue();
+  });
+
+  if(!hasVertices)
+    cursor.FailAt(offset, "Edge contains no Vertices");
+  RequireField(cursor, offset, hasType, "Type");
+
+  if(type == "LineSegment") {
+    edge.isArc = false;
+  }
+  else if(type == "CircularArc") {
+    edge.isArc = true;
+    RequireField(cursor, offset, hasClockwiseFrom, "ClockwiseFrom");
+    if(!hasCenter)
+      cursor.FailAt(offset, "Arc has no center");
+  }
+  else
+    cursor.FailAt(offset, "Unkown edge type: " + type.ToString());
+}
+
+void ParseEdges(JsonCursor& cursor, LoadState& state) {
+  cursor.ParseObject([&](const JsonString&) {
+    state.edges.emplace_back();
+    ParseEdge(cursor, state.ids, state.edges.back());
+  });
+}
+
+//Turns the id references gathered by either loader into an IndexedPath.
+void ResolveEdges(LoadState& state, IndexedPath& out) {
+  state.ids.Finalize();
+
+  out.lines.clear();
+  out.arcs.clear();
+  for(const auto& edge : state.edges) {
+    const uint32_t v0 = state.ids.Resolve(edge.v0);
+    const uint32_t v1 = state.ids.Resolve(edge.v1);
+
+    if(!edge.isArc) {
+      out.lines.push_back({ v0, v1 });
+    }
+    //Ensure that v0 is the first vertex on the arc, moving counter-clockwise.
+    else if(edge.v1 == edge.clockwiseFrom) {
+      out.arcs.push_back({ v0, v1, edge.center });
+    }
+    else {
+      out.arcs.push_back({ v1, v0, edge.center });
+    }
+  }
+
+  out.vertices.swap(state.positions);
+}
+
+//A run of "Vertices" or "Edges" members parsed on its own. String ids are
+//interned into the chunk's table and re-keyed when chunks are merged.
+struct PathChunk {
+  JsonRange range;
+  bool isVertices;
+
+  VertexIdTable ids;
+  std::vector<VertexIdTable::Key> vertexKeys;
+  std::vector<Vector2> positions;
+  std::vector<LoadState::PendingEdge> edges;
+  bool failed = false;
+};
+
+//Finds the Vertices and Edges members of the document, in document order,
+//and cuts them into chunks. Returns false if the document doesn't have the
+//expected shape; the serial loader then reports the problem.
+bool SplitDocument(const char* data, size_t size, size_t targetBytes, std::vector<std::unique_ptr<PathChunk>>& chunks) {
+  try {
+    JsonCursor cursor(data, data + size);
+    if(cursor.Peek() != '{')
+      return false;
+
+    bool hasVertices = false;
+    bool hasEdges = false;
+    std::vector<JsonRange> ranges;
+    cursor.ParseObject([&](const JsonString& key) {
+      const bool isVertices = key == "Vertices";
+      if(!isVertices && key != "Edges") {
+        cursor.SkipValue();
+        return;
+      }
+      (isVertices ? hasVertices : hasEdges) = true;
+      if(cursor.Peek() != '{')
+        cursor.Fail("expected object");
+
+      ranges.clear();
+      cursor.SplitObjectMembers(targetBytes, ranges);
+      for(const auto& range : ranges) {
+        chunks.emplace_back(new PathChunk);
+        chunks.back()->range = range;
+        chunks.back()->isVertices = isVertices;
+      }
+    });
+    cursor.ExpectEnd();
+    return hasVertices && hasEdges;
+  }
+  catch(const std::runtime_error&) {
+    return false;
+  }
+}
+
+void ParseChunk(const char* data, PathChunk& chunk) {
+  try {
+    JsonCursor cursor(data, chunk.range.begin, chunk.range.end);
+    if(chunk.isVertices) {
+      cursor.ParseMembers([&](const JsonString& key) {
+        chunk.vertexKeys.push_back(chunk.ids.KeyFromString(key.data, key.size));
+        chunk.positions.push_back(ParseVertex(cursor));
+      });
+    }
+    else {
+      cursor.ParseMembers([&](const JsonString&) {
+        chunk.edges.emplace_back();
+        ParseEdge(cursor, chunk.ids, chunk.edges.back());
+      });
+    }
+  }
+  catch(const std::runtime_error&) {
+    chunk.failed = true;
+  }
+}
+
+void ParseDocument(JsonCursor& cursor, LoadState& state) {
+  if(cursor.Peek() != '{')
+    cursor.Fail("expected a path document object");
+
+  bool hasVertices = false;
+  bool hasEdges = false;
+  cursor.ParseObject([&](const JsonString& key) {
+    if(key == "Vertices") {
+      hasVertices = true;
+      ParseVertices(cursor, state);
+    }
+    else if(key == "Edges") {
+      hasEdges = true;
+      ParseEdges(cursor, state);
+    }
+    else
+      cursor.SkipValue();
+  });
+  cursor.ExpectEnd();
+
+  RequireField(cursor, 0, hasVertices, "Vertices");
+  RequireField(cursor, 0, hasEdges, "Edges");
+}
+
+}
+
+PathLoader::PathLoader() : m_state(new PathLoadState) {}
+
+PathLoader::~PathLoader() {}
+
+void PathLoader::Load(std::istream& input, IndexedPath& out) {
+  const std::string document((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+  if(input.bad())
+    throw std::runtime_error("Error reading path document");
+  Load(document.data(), document.size(), out);
+}
+
+void PathLoader::Load(const char* data, size_t size, IndexedPath& out) {
+  if(IsBinaryPath(data, size)) {
+    MakeIndexedPath(ParseBinaryPath(data, size), out);
+    return;
+  }
+
+  auto& state = *m_state;
+  state.Reset();
+
+  JsonCursor cursor(data, data + size);
+  ParseDocument(cursor, state);
+  ResolveEdges(state, out);
+}
+
+void PathLoader::LoadParallel(const char* data, size_t size, IndexedPath& out, ThreadPool& pool) {
+  if(size < PARALLEL_LOAD_MIN_BYTES || pool.ThreadCount() < 2 || IsBinaryPath(data, size)) {
+    Load(data, size, out);
+    return;
+  }
+
+  //A few chunks per thread so stealing can even out uneven chunks.
+  const size_t targetBytes = size / (pool.ThreadCount() * 4);
+  std::vector<std::unique_ptr<PathChunk>> chunks;
+  if(!SplitDocument(data, size, targetBytes, chunks)) {
+    Load(data, size, out);
+    return;
+  }
+
+  for(auto& chunk : chunks) {
+    PathChunk* target = chunk.get();
+    pool.Submit([data, target] { ParseChunk(data, *target); });
+  }
+  pool.Wait();
+
+  //Any error is reported by rerunning the serial loader, so messages and
+  //offsets match it exactly.
+  for(const auto& chunk : chunks) {
+    if(chunk->failed) {
+      Load(data, size, out);
+      return;
+    }
+  }
+
+  //Merge in document order so duplicate ids resolve as they would serially.
+  auto& state = *m_state;
+  state.Reset();
+  for(const auto& chunk : chunks) {
+    for(size_t i = 0; i < chunk->positions.size(); ++i) {
+      state.ids.Define(state.ids.ImportKey(chunk->ids, chunk->vertexKeys[i]),
+                       static_cast<uint32_t>(state.positions.size()));
+      state.positions.push_back(chunk->positions[i]);
+    }
+    for(auto edge : chunk->edges) {
+      edge.v0 = state.ids.ImportKey(chunk->ids, edge.v0);
+      edge.v1 = state.ids.ImportKey(chunk->ids, edge.v1);
+      if(edge.isArc)
+        edge.clockwiseFrom = state.ids.ImportKey(chunk->ids, edge.clockwiseFrom);
+      state.edges.push_back(edge);
+    }
+  }
+
+  ResolveEdges(state, out);
+}
+
+void PathLoader::LoadFile(const std::string& filename, IndexedPath& out) {
+  MappedFile file(filename);
+  Load(file.Data(), file.Size(), out);
+}
+
+IndexedPath LoadIndexedPath(std::istream& input) {
+  IndexedPath path;
+  PathLoader().Load(input, path);
+  return path;
+}
+
+IndexedPath LoadIndexedPath(const char* data, size_t size) {
+  IndexedPath path;
+  PathLoader().Load(data, size, path);
+  return path;
+}
+
+ToolPath LoadToolPath(std::istream& input) {
+  return MakeToolPath(LoadIndexedPath(input));
+}
+
+ToolPath LoadToolPathFile(const std::string& filename) {
+  MappedFile file(filename);
+  if(IsBinaryPath(file.Data(), file.Size()))
+    return MakeToolPath(ParseBinaryPath(file.Data(), file.Size()));
+
+  IndexedPath path;
+  PathLoader().Load(file.Data(), file.Size(), path);
+  return MakeToolPath(path);
+}
+
+IndexedPath LoadIndexedPathFile(const std::string& filename) {
+  IndexedPath path;
+  PathLoader().LoadFile(filename, path);
+  return path;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "IndexedPath.h"
+#include "ToolPath.h"
+#include <istream>
+#include <memory>
+#include <string>
+
+//Builds a ToolPath straight from a path document in a single pass.
+//Unlike ToolPath(const picojson::value&), no picojson DOM is materialized:
+//the document is read in place with a JsonCursor, vertices go into a flat
+//position table and edges are resolved against it once the document has
+//been read, since "Edges" may precede "Vertices". Parse errors carry the
+//byte offset they were found at.
+//
+//Prefer the in-memory and file overloads; the istream one has to read the
+//whole stream into a buffer first.
+ToolPath LoadToolPath(std::istream& input);
+IndexedPath LoadIndexedPath(std::istream& input);
+IndexedPath LoadIndexedPath(const char* data, size_t size);
+
+//Loads either a json path document or a binary path (see PathBinary.h),
+//picking the format from the file contents.
+ToolPath LoadToolPathFile(const std::string& filename);
+IndexedPath LoadIndexedPathFile(const std::string& filename);
+
+struct PathLoadState;
+class ThreadPool;
+
+//Loader that keeps its scratch buffers between documents, for long running
+//processes that load many paths. Load swaps buffers with out, so passing the
+//same IndexedPath back in each time recycles its allocations too.
+//Not thread safe; use one per thread.
+class PathLoader {
+public:
+  PathLoader();
+  ~PathLoader();
+
+  void Load(std::istream& input, IndexedPath& out);
+
+  //Loads a json or binary path held in memory, picking the format from its contents.
+  void Load(const char* data, size_t size, IndexedPath& out);
+  void LoadFile(const std::string& filename, IndexedPath& out);
+
+  //Same result as Load, but large json documents are parsed on pool: a
+  //structural scan cuts the Vertices and Edges objects into runs of
+  //members, the runs are parsed concurrently and merged in document order.
+  //Must not be called from one of pool's threads.
+  void LoadParallel(const char* data, size_t size, IndexedPath& out, ThreadPool& pool);
+
+private:
+  std::unique_ptr<PathLoadState> m_state;
+};
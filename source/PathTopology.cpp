@@ -0,0 +1,182 @@
+#include "PathTopology.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+const uint32_t PathTopology::NO_COMPONENT;
+const uint32_t PathTopology::NO_HALF_EDGE;
+
+namespace {
+
+//Union-find over vertex indices, with union by size and path halving.
+class DisjointSets {
+public:
+  explicit DisjointSets(size_t count) : m_parent(count), m_size(count, 1) {
+    for(size_t i = 0; i < count; ++i)
+      m_parent[i] = static_cast<uint32_t>(i);
+  }
+
+  uint32_t Find(uint32_t x) {
+    while(m_parent[x] != x) {
+      m_parent[x] = m_parent[m_parent[x]];
+      x = m_parent[x];
+    }
+    return x;
+  }
+
+  void Union(uint32_t a, uint32_t b) {
+    a = Find(a);
+    b = Find(b);
+    if(a == b)
+      return;
+    if(m_size[a] < m_size[b])
+      std::swap(a, b);
+    m_parent[b] = a;
+    m_size[a] += m_size[b];
+  }
+
+private:
+  std::vector<uint32_t> m_parent;
+  std::vector<uint32_t> m_size;
+};
+
+struct EdgeEnds {
+  uint32_t v0, v1;
+};
+
+uint32_t OtherEnd(const EdgeEnds& edge, uint32_t vertex) {
+  return edge.v0 == vertex ? edge.v1 : edge.v0;
+}
+
+}
+
+uint32_t PathTopology::Origin(const IndexedPath& path, uint32_t halfEdge) const {
+  const uint32_t edge = Edge(halfEdge);
+  const bool forwards = (halfEdge & 1) == 0;
+  if(IsArc(edge)) {
+    const auto& arc = path.arcs[edge - lineCount];
+    return forwards ? arc.v0 : arc.v1;
+  }
+  const auto& line = path.lines[edge];
+  return forwards ? line.v0 : line.v1;
+}
+
+size_t PathTopology::OpenChainCount() const {
+  return static_cast<size_t>(std::count(contourClosed.begin(), contourClosed.end(), uint8_t(0)));
+}
+
+PathTopology AnalyzeTopology(const IndexedPath& path) {
+  const size_t vertexCount = path.vertices.size();
+
+  std::vector<EdgeEnds> edges;
+  edges.reserve(path.lines.size() + path.arcs.size());
+  for(const auto& line : path.lines)
+    edges.push_back({ line.v0, line.v1 });
+  for(const auto& arc : path.arcs)
+    edges.push_back({ arc.v0, arc.v1 });
+
+  for(size_t e = 0; e < edges.size(); ++e) {
+    if(edges[e].v0 >= vertexCount || edges[e].v1 >= vertexCount)
+      throw std::runtime_error("Edge " + std::to_string(e) + " references a vertex outside the path");
+  }
+
+  PathTopology topology;
+  topology.lineCount = static_cast<uint32_t>(path.lines.size());
+
+  //Counting sort of edge ends by vertex gives the CSR adjacency.
+  topology.adjacencyOffsets.assign(vertexCount + 1, 0);
+  for(const auto& edge : edges) {
+    ++topology.adjacencyOffsets[edge.v0 + 1];
+    ++topology.adjacencyOffsets[edge.v1 + 1];
+  }
+  for(size_t v = 0; v < vertexCount; ++v)
+    topology.adjacencyOffsets[v + 1] += topology.adjacencyOffsets[v];
+
+  topology.adjacency.resize(edges.size() * 2);
+  std::vector<uint32_t> fill(topology.adjacencyOffsets.begin(), topology.adjacencyOffsets.end() - 1);
+  for(size_t e = 0; e < edges.size(); ++e) {
+    topology.adjacency[fill[edges[e].v0]++] = static_cast<uint32_t>(e);
+    topology.adjacency[fill[edges[e].v1]++] = static_cast<uint32_t>(e);
+  }
+
+  //Components, numbered by the first vertex of each.
+  DisjointSets sets(vertexCount);
+  for(const auto& edge : edges)
+    sets.Union(edge.v0, edge.v1);
+
+  topology.vertexComponent.assign(vertexCount, PathTopology::NO_COMPONENT);
+  std::vector<uint32_t> rootComponent(vertexCount, PathTopology::NO_COMPONENT);
+  for(uint32_t v = 0; v < vertexCount; ++v) {
+    if(topology.Degree(v) == 0)
+      continue;
+    auto& component = rootComponent[sets.Find(v)];
+    if(component == PathTopology::NO_COMPONENT)
+      component = static_cast<uint32_t>(topology.componentCount++);
+    topology.vertexComponent[v] = component;
+  }
+
+  //Contours: every edge is walked exactly once.
+  std::vector<uint8_t> used(edges.size(), 0);
+  const auto walk = [&](uint32_t start, uint32_t firstEdge) {
+    topology.contourOffsets.push_back(static_cast<uint32_t>(topology.contourHalfEdges.size()));
+    topology.contourStart.push_back(start);
+
+    uint32_t edge = firstEdge;
+    uint32_t vertex = start;
+    while(true) {
+      used[edge] = 1;
+      topology.contourHalfEdges.push_back(2 * edge + (edges[edge].v0 == vertex ? 0 : 1));
+      vertex = OtherEnd(edges[edge], vertex);
+      if(vertex == start || topology.Degree(vertex) != 2)
+        break;
+
+      //Continue through the other edge at this vertex, if it is still free.
+      uint32_t next = edge;
+      for(uint32_t i = topology.adjacencyOffsets[vertex]; i < topology.adjacencyOffsets[vertex + 1]; ++i) {
+        if(!used[topology.adjacency[i]])
+          next = topology.adjacency[i];
+      }
+      if(next == edge)
+        break;
+      edge = next;
+    }
+    topology.contourClosed.push_back(vertex == start ? 1 : 0);
+  };
+
+  //Runs that end somewhere other than a plain two edge vertex start at
+  //those ends; whatever is left are simple loops.
+  for(uint32_t v = 0; v < vertexCount; ++v) {
+    if(topology.Degree(v) == 0 || topology.Degree(v) == 2)
+      continue;
+    for(uint32_t i = topology.adjacencyOffsets[v]; i < topology.adjacencyOffsets[v + 1]; ++i) {
+      if(!used[topology.adjacency[i]])
+        walk(v, topology.adjacency[i]);
+    }
+  }
+  for(uint32_t e = 0; e < edges.size(); ++e) {
+    if(!used[e])
+      walk(edges[e].v0, e);
+  }
+  topology.contourOffsets.push_back(static_cast<uint32_t>(topology.contourHalfEdges.size()));
+
+  //Link consecutive half-edges of each contour, and their twins the other way.
+  topology.halfEdgeNext.assign(edges.size() * 2, PathTopology::NO_HALF_EDGE);
+  topology.halfEdgePrev.assign(edges.size() * 2, PathTopology::NO_HALF_EDGE);
+  const auto link = [&](uint32_t from, uint32_t to) {
+    topology.halfEdgeNext[from] = to;
+    topology.halfEdgePrev[to] = from;
+    topology.halfEdgeNext[PathTopology::Twin(to)] = PathTopology::Twin(from);
+    topology.halfEdgePrev[PathTopology::Twin(from)] = PathTopology::Twin(to);
+  };
+  for(size_t c = 0; c < topology.ContourCount(); ++c) {
+    const uint32_t begin = topology.contourOffsets[c];
+    const uint32_t end = topology.contourOffsets[c + 1];
+    for(uint32_t i = begin; i + 1 < end; ++i)
+      link(topology.contourHalfEdges[i], topology.contourHalfEdges[i + 1]);
+    if(topology.contourClosed[c])
+      link(topology.contourHalfEdges[end - 1], topology.contourHalfEdges[begin]);
+  }
+
+  return topology;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "IndexedPath.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//Connectivity of a path: which edges meet at which vertices, how they group
+//into separate pieces, and how each piece splits into contours.
+//
+//Edges are numbered lines first, then arcs: edge e is path.lines[e] for
+//e < path.lines.size(), else path.arcs[e - path.lines.size()]. The number is
+//the edge's type tag, so no per edge tag is stored.
+//
+//Each edge e is also split into two half-edges: 2e runs from its v0 to its
+//v1, and its twin 2e + 1 runs back. Contours are sequences of half-edges, so
+//a walk never has to work out which way it crosses an edge.
+//
+//A contour is a maximal run of edges through vertices where exactly two
+//edges meet. It is closed when it returns to its start vertex. Simple
+//shapes are one closed contour each; an open contour is a dangling chain,
+//or a run between two junctions where three or more edges meet.
+struct PathTopology {
+  static const uint32_t NO_COMPONENT = UINT32_MAX;
+  static const uint32_t NO_HALF_EDGE = UINT32_MAX;
+
+  uint32_t lineCount = 0;
+
+  //Vertex to edge adjacency in compressed sparse row form: the edges at
+  //vertex v are adjacency[adjacencyOffsets[v] .. adjacencyOffsets[v + 1]).
+  //An edge from a vertex to itself is listed there twice.
+  std::vector<uint32_t> adjacencyOffsets;
+  std::vector<uint32_t> adjacency;
+
+  //Connected component of each vertex, numbered in vertex order, or
+  //NO_COMPONENT for a vertex no edge uses.
+  std::vector<uint32_t> vertexComponent;
+  size_t componentCount = 0;
+
+  //Contour c walks the half-edges contourHalfEdges[contourOffsets[c] ..
+  //contourOffsets[c + 1]) in order, starting from contourStart[c].
+  std::vector<uint32_t> contourOffsets;
+  std::vector<uint32_t> contourHalfEdges;
+  std::vector<uint32_t> contourStart;
+  std::vector<uint8_t> contourClosed;
+
+  //The half-edge that continues from each one along its contour, and the
+  //one it continues from, in either direction of travel: the links of a
+  //twin are the twins of the reversed links. NO_HALF_EDGE where an open
+  //contour ends; a closed contour links around.
+  std::vector<uint32_t> halfEdgeNext;
+  std::vector<uint32_t> halfEdgePrev;
+
+  size_t ContourCount() const { return contourStart.size(); }
+  size_t Degree(uint32_t vertex) const { return adjacencyOffsets[vertex + 1] - adjacencyOffsets[vertex]; }
+  size_t OpenChainCount() const;
+
+  static uint32_t Edge(uint32_t halfEdge) { return halfEdge >> 1; }
+  static uint32_t Twin(uint32_t halfEdge) { return halfEdge ^ 1; }
+  bool IsArc(uint32_t edge) const { return edge >= lineCount; }
+
+  //Where a half-edge of path starts and ends.
+  uint32_t Origin(const IndexedPath& path, uint32_t halfEdge) const;
+  uint32_t Target(const IndexedPath& path, uint32_t halfEdge) const { return Origin(path, Twin(halfEdge)); }
+};
+
+//Builds the adjacency, components and contours in time linear in the
+//number of vertices and edges. Throws a runtime_error for an edge that
+//references a vertex outside path.vertices.
+PathTopology AnalyzeTopology(const IndexedPath& path);
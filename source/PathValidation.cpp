@@ -0,0 +1,617 @@
+#include "PathValidation.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+std::atomic<bool> g_geometryValidation(false);
+
+//Cells are made coarser until the edges cover at most this many each on average.
+const double MAX_CELLS_PER_EDGE = 3;
+
+//Error messages name this many edges, then count the rest.
+const size_t MAX_REPORTED_EDGES = 20;
+
+const double INFINITE = std::numeric_limits<double>::infinity();
+
+struct Box {
+  Vector2 min, max;
+};
+
+//A line from a to b or, with a positive radius, the counter-clockwise arc
+//from a to b around center, sweeping from the angle start.
+struct Shape {
+  Vector2 a, b;
+  Vector2 center;
+  double radius;
+  double start, sweep;
+
+  bool IsArc() const { return radius > 0; }
+};
+
+Shape ArcShape(const Vector2& a, const Vector2& b, const Vector2& center) {
+  const double start = atan2(a.y - center.y, a.x - center.x);
+  double end = atan2(b.y - center.y, b.x - center.x);
+  if(end <= start)
+    end += 2*M_PI;
+  return { a, b, center, Distance(center, a), start, end - start };
+}
+
+Box ShapeBox(const Shape& shape) {
+  Box box = { { std::min(shape.a.x, shape.b.x), std::min(shape.a.y, shape.b.y) },
+              { std::max(shape.a.x, shape.b.x), std::max(shape.a.y, shape.b.y) } };
+
+  //Arcs also reach out where they pass the axis directions.
+  if(shape.IsArc()) {
+    const Vector2 directions[] = { { 1, 0 }, { 0, 1 }, { -1, 0 }, { 0, -1 } };
+    for(int k = -2; k <= 6; ++k) {
+      const double theta = M_PI_2 * k;
+      if(theta < shape.start || theta > shape.start + shape.sweep)
+        continue;
+      const auto& direction = directions[(k + 4) % 4];
+      const Vector2 point = { shape.center.x + shape.radius * direction.x, shape.center.y + shape.radius * direction.y };
+      box.min = { std::min(box.min.x, point.x), std::min(box.min.y, point.y) };
+      box.max = { std::max(box.max.x, point.x), std::max(box.max.y, point.y) };
+    }
+  }
+
+  box.min = { box.min.x - CONTACT_TOLERANCE, box.min.y - CONTACT_TOLERANCE };
+  box.max = { box.max.x + CONTACT_TOLERANCE, box.max.y + CONTACT_TOLERANCE };
+  return box;
+}
+
+//Positive when a, b, c turn counter-clockwise.
+double Cross(const Vector2& a, const Vector2& b, const Vector2& c) {
+  return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+
+//Angle of p around the arc's center, counter-clockwise from its start, in [0, 2pi).
+double ArcOffset(const Shape& arc, const Vector2& p) {
+  double offset = atan2(p.y - arc.center.y, p.x - arc.center.x) - arc.start;
+  while(offset < 0)
+    offset += 2*M_PI;
+  while(offset >= 2*M_PI)
+    offset -= 2*M_PI;
+  return offset;
+}
+
+//Whether a point on the arc's circle is within the tolerance of the arc.
+bool WithinSweep(const Shape& arc, const Vector2& p) {
+  const double slack = CONTACT_TOLERANCE / arc.radius;
+  const double offset = ArcOffset(arc, p);
+  return offset <= arc.sweep + slack || offset >= 2*M_PI - slack;
+}
+
+double DistanceToShape(const Shape& shape, const Vector2& p) {
+  if(shape.IsArc()) {
+    if(ArcOffset(shape, p) <= shape.sweep)
+      return std::abs(Distance(shape.center, p) - shape.radius);
+    return std::min(Distance(shape.a, p), Distance(shape.b, p));
+  }
+
+  const auto direction = shape.b - shape.a;
+  const double lengthSquared = Dot(direction, direction);
+  if(!(lengthSquared > 0))
+    return Distance(shape.a, p);
+  const double t = std::max(0.0, std::min(1.0, Dot(p - shape.a, direction) / lengthSquared));
+  return Distance({ shape.a.x + direction.x * t, shape.a.y + direction.y * t }, p);
+}
+
+//Parameters along the line where it comes within the tolerance of the arc's
+//circle: the two crossings, or the closest point on a near miss.
+size_t LineCircle(const Shape& line, const Shape& arc, double* t) {
+  const auto direction = line.b - line.a;
+  const double lengthSquared = Dot(direction, direction);
+  if(!(lengthSquared > 0))
+    return 0;
+  const double closest = Dot(arc.center - line.a, direction) / lengthSquared;
+  const Vector2 foot = { line.a.x + direction.x * closest, line.a.y + direction.y * closest };
+  const double gap = Distance(foot, arc.center);
+  if(gap > arc.radius + CONTACT_TOLERANCE)
+    return 0;
+  const double halfChord = sqrt(std::max(0.0, arc.radius * arc.radius - gap * gap) / lengthSquared);
+  t[0] = closest - halfChord;
+  t[1] = closest + halfChord;
+  return 2;
+}
+
+//Points where the circles of two arcs that aren't the same circle meet, or
+//come closest on a near miss.
+size_t CircleCircle(const Shape& first, const Shape& second, Vector2* points) {
+  const double d = Distance(first.center, second.center);
+  if(d > first.radius + second.radius + CONTACT_TOLERANCE ||
+     d < std::abs(first.radius - second.radius) - CONTACT_TOLERANCE || !(d > 0))
+    return 0;
+  const auto axis = (second.center - first.center) / d;
+  const double along = (d * d + first.radius * first.radius - second.radius * second.radius) / (2 * d);
+  const double across = sqrt(std::max(0.0, first.radius * first.radius - along * along));
+  const Vector2 base = { first.center.x + axis.x * along, first.center.y + axis.y * along };
+  points[0] = { base.x - axis.y * across, base.y + axis.x * across };
+  points[1] = { base.x + axis.y * across, base.y - axis.x * across };
+  return 2;
+}
+
+Vector2 ArcMidpoint(const Shape& arc) {
+  const double angle = arc.start + arc.sweep / 2;
+  return { arc.center.x + arc.radius * cos(angle), arc.center.y + arc.radius * sin(angle) };
+}
+
+//Whether two edges meet anywhere other than at endpoints they share.
+bool InContact(const Shape& first, const Shape& second) {
+  Vector2 shared[2];
+  size_t sharedCount = 0;
+  for(const auto& p : { first.a, first.b }) {
+    if(Distance(p, second.a) <= CONTACT_TOLERANCE || Distance(p, second.b) <= CONTACT_TOLERANCE)
+      shared[sharedCount++] = p;
+  }
+  const auto awayFromShared = [&](const Vector2& p) {
+    for(size_t i = 0; i < sharedCount; ++i) {
+      if(Distance(p, shared[i]) <= CONTACT_TOLERANCE)
+        return false;
+    }
+    return true;
+  };
+
+  //An endpoint on the other edge covers T junctions and every overlap.
+  for(const auto& p : { first.a, first.b }) {
+    if(awayFromShared(p) && DistanceToShape(second, p) <= CONTACT_TOLERANCE)
+      return true;
+  }
+  for(const auto& p : { second.a, second.b }) {
+    if(awayFromShared(p) && DistanceToShape(first, p) <= CONTACT_TOLERANCE)
+      return true;
+  }
+
+  //What's left are crossings through the middle of both.
+  if(!first.IsArc() && !second.IsArc()) {
+    //Lines sharing both ends are the same line, drawn twice.
+    if(sharedCount == 2)
+      return Distance(first.a, first.b) > CONTACT_TOLERANCE;
+    const double before = Cross(second.a, second.b, first.a);
+    const double after = Cross(second.a, second.b, first.b);
+    if(!((before > 0 && after < 0) || (before < 0 && after > 0)))
+      return false;
+    const double secondBefore = Cross(first.a, first.b, second.a);
+    const double secondAfter = Cross(first.a, first.b, second.b);
+    if(!((secondBefore > 0 && secondAfter < 0) || (secondBefore < 0 && secondAfter > 0)))
+      return false;
+    const double t = before / (before - after);
+    return awayFromShared({ first.a.x + (first.b.x - first.a.x) * t, first.a.y + (first.b.y - first.a.y) * t });
+  }
+
+  if(first.IsArc() != second.IsArc()) {
+    const auto& line = first.IsArc() ? second : first;
+    const auto& arc = first.IsArc() ? first : second;
+    const double slack = CONTACT_TOLERANCE / Distance(line.a, line.b);
+    double t[2];
+    const size_t count = LineCircle(line, arc, t);
+    for(size_t i = 0; i < count; ++i) {
+      const Vector2 point = { line.a.x + (line.b.x - line.a.x) * t[i], line.a.y + (line.b.y - line.a.y) * t[i] };
+      if(t[i] >= -slack && t[i] <= 1 + slack && WithinSweep(arc, point) && awayFromShared(point))
+        return true;
+    }
+    return false;
+  }
+
+  //Arcs of one circle only meet by overlapping; with their endpoints already
+  //tested, that leaves one running exactly along the other.
+  if(Distance(first.center, second.center) <= CONTACT_TOLERANCE &&
+     std::abs(first.radius - second.radius) <= CONTACT_TOLERANCE) {
+    const auto firstMid = ArcMidpoint(first);
+    const auto secondMid = ArcMidpoint(second);
+    return (awayFromShared(firstMid) && DistanceToShape(second, firstMid) <= CONTACT_TOLERANCE) ||
+           (awayFromShared(secondMid) && DistanceToShape(first, secondMid) <= CONTACT_TOLERANCE);
+  }
+
+  Vector2 points[2];
+  const size_t count = CircleCircle(first, second, points);
+  for(size_t i = 0; i < count; ++i) {
+    if(WithinSweep(first, points[i]) && WithinSweep(second, points[i]) && awayFromShared(points[i]))
+      return true;
+  }
+  return false;
+}
+
+//Sparse uniform grid: one entry per cell an edge passes through, within the
+//tolerance, sorted by cell. Lines are walked a column at a time so a long
+//diagonal line only lands in the cells it crosses; arcs take every cell of
+//their box.
+class EdgeGrid {
+public:
+  struct Entry {
+    uint64_t cell;
+    uint32_t edge;
+  };
+
+  EdgeGrid(const std::vector<Shape>& shapes, const std::vector<Box>& boxes) {
+    if(boxes.empty())
+      return;
+
+    Box extent = boxes[0];
+    double meanSize = 0;
+    for(const auto& box : boxes) {
+      extent.min = { std::min(extent.min.x, box.min.x), std::min(extent.min.y, box.min.y) };
+      extent.max = { std::max(extent.max.x, box.max.x), std::max(extent.max.y, box.max.y) };
+      meanSize += std::max(box.max.x - box.min.x, box.max.y - box.min.y);
+    }
+    meanSize /= boxes.size();
+    m_origin = extent.min;
+
+    //Starts finer than the mean edge, as a line costs one entry per cell it
+    //crosses and small cells hold fewer, more nearly parallel pieces. Coarse
+    //enough that cell coordinates fit in 32 bits and long edges don't flood
+    //the grid.
+    const double span = std::max(extent.max.x - extent.min.x, extent.max.y - extent.min.y);
+    m_cellSize = std::max(meanSize / 2, span / (1u << 30));
+    if(!(m_cellSize > 0))
+      m_cellSize = 1;
+    double estimate = EstimateEntries(shapes, boxes);
+    while(estimate > MAX_CELLS_PER_EDGE * boxes.size()) {
+      m_cellSize *= 2;
+      estimate = EstimateEntries(shapes, boxes);
+    }
+
+    //Keys hold the row in the low bits, as few as the grid's rows need.
+    while((uint64_t(1) << m_rowBits) <= Row(extent.max.y))
+      ++m_rowBits;
+    uint32_t columnBits = 0;
+    while((uint64_t(1) << columnBits) <= Column(extent.max.x))
+      ++columnBits;
+
+    m_entries.reserve(static_cast<size_t>(estimate));
+    for(uint32_t edge = 0; edge < boxes.size(); ++edge)
+      VisitCells(shapes[edge], boxes[edge], [&](uint64_t cell) { m_entries.push_back({ cell, edge }); });
+    SortEntries(m_rowBits + columnBits);
+  }
+
+  const std::vector<Entry>& Entries() const { return m_entries; }
+
+  Box CellBox(uint64_t cell) const {
+    const double x = m_origin.x + double(cell >> m_rowBits) * m_cellSize;
+    const double y = m_origin.y + double(cell & ((uint64_t(1) << m_rowBits) - 1)) * m_cellSize;
+    return { { x, y }, { x + m_cellSize, y + m_cellSize } };
+  }
+
+private:
+  uint64_t Key(uint32_t x, uint32_t y) const { return (uint64_t(x) << m_rowBits) | y; }
+
+  //Least significant digit first radix sort on the cell keys, over only the
+  //bits they use.
+  void SortEntries(uint32_t keyBits) {
+    const uint32_t digitBits = 11;
+    const size_t digits = size_t(1) << digitBits;
+    std::vector<Entry> scratch(m_entries.size());
+    std::vector<size_t> offsets(digits);
+    for(uint32_t shift = 0; shift < keyBits; shift += digitBits) {
+      std::fill(offsets.begin(), offsets.end(), 0);
+      for(const auto& entry : m_entries)
+        ++offsets[(entry.cell >> shift) & (digits - 1)];
+      size_t total = 0;
+      for(auto& offset : offsets) {
+        const size_t count = offset;
+        offset = total;
+        total += count;
+      }
+      for(const auto& entry : m_entries)
+        scratch[offsets[(entry.cell >> shift) & (digits - 1)]++] = entry;
+      m_entries.swap(scratch);
+    }
+  }
+
+  uint32_t Column(double x) const {
+    return static_cast<uint32_t>(std::max(0.0, (x - m_origin.x) / m_cellSize));
+  }
+
+  uint32_t Row(double y) const {
+    return static_cast<uint32_t>(std::max(0.0, (y - m_origin.y) / m_cellSize));
+  }
+
+  //About the number of cells VisitCells calls back with, without walking them.
+  double EstimateEntries(const std::vector<Shape>& shapes, const std::vector<Box>& boxes) const {
+    double entries = 0;
+    for(size_t i = 0; i < boxes.size(); ++i) {
+      const double columns = double(Column(boxes[i].max.x) - Column(boxes[i].min.x) + 1);
+      const double rows = double(Row(boxes[i].max.y) - Row(boxes[i].min.y) + 1);
+      entries += shapes[i].IsArc() ? columns * rows : columns + rows - 1;
+    }
+    return entries;
+  }
+
+  template<class Visit>
+  void VisitCells(const Shape& shape, const Box& box, Visit visit) const {
+    const uint32_t x0 = Column(box.min.x), x1 = Column(box.max.x);
+    const double dx = shape.b.x - shape.a.x;
+    if(shape.IsArc() || dx == 0) {
+      const uint32_t y0 = Row(box.min.y), y1 = Row(box.max.y);
+      for(uint32_t x = x0; x <= x1; ++x) {
+        for(uint32_t y = y0; y <= y1; ++y)
+          visit(Key(x, y));
+      }
+      return;
+    }
+
+    //The rows the line spans over each column, widened by the tolerance.
+    const double slope = (shape.b.y - shape.a.y) / dx;
+    const double left = std::min(shape.a.x, shape.b.x), right = std::max(shape.a.x, shape.b.x);
+    for(uint32_t x = x0; x <= x1; ++x) {
+      const double from = std::max(left, m_origin.x + double(x) * m_cellSize);
+      const double to = std::min(right, m_origin.x + double(x + 1) * m_cellSize);
+      const double yFrom = shape.a.y + (from - shape.a.x) * slope;
+      const double yTo = shape.a.y + (to - shape.a.x) * slope;
+      const uint32_t y0 = Row(std::max(box.min.y, std::min(yFrom, yTo) - CONTACT_TOLERANCE));
+      const uint32_t y1 = Row(std::min(box.max.y, std::max(yFrom, yTo) + CONTACT_TOLERANCE));
+      for(uint32_t y = y0; y <= y1; ++y)
+        visit(Key(x, y));
+    }
+  }
+
+  Vector2 m_origin = { 0, 0 };
+  double m_cellSize = 1;
+  uint32_t m_rowBits = 0;
+  std::vector<Entry> m_entries;
+};
+
+//The part of an edge inside one cell, as an interval across the cell's sweep
+//direction and one along it.
+struct Piece {
+  double acrossMin, acrossMax;
+  double alongMin, alongMax;
+  uint32_t part; //Index into the cell's parts
+};
+
+//Where an edge runs in a cell: the clipped line from one end to the other,
+//or a box between the two corners. A line also keeps its equation, scaled by
+//its length: Side is the distance of a point to its left, times the length.
+struct CellPart {
+  uint32_t edge;
+  Vector2 from, to;
+  bool isBox;
+  Vector2 normal;
+  double offset;
+  double margin; //The tolerance, times the length
+
+  double Side(const Vector2& p) const { return normal.x * p.x + normal.y * p.y + offset; }
+};
+
+CellPart LinePart(uint32_t edge, const Vector2& from, const Vector2& to) {
+  const Vector2 normal = { from.y - to.y, to.x - from.x };
+  return { edge, from, to, false, normal, -Dot(normal, from), CONTACT_TOLERANCE * Distance(from, to) };
+}
+
+CellPart BoxPart(uint32_t edge, const Vector2& min, const Vector2& max) {
+  return { edge, min, max, true, { 0, 0 }, 0, 0 };
+}
+
+//Whether one part lies wholly to one side of the other's line, more than
+//the tolerance away. Only a cheap filter: parts it can't separate may still
+//be apart.
+bool Separated(const CellPart& first, const CellPart& second) {
+  const auto oneSide = [](const CellPart& line, const CellPart& other) {
+    if(line.isBox)
+      return false;
+    const double from = line.Side(other.from);
+    const double to = line.Side(other.to);
+    if(!other.isBox)
+      return (from > line.margin && to > line.margin) || (from < -line.margin && to < -line.margin);
+    const double corner0 = line.Side({ other.from.x, other.to.y });
+    const double corner1 = line.Side({ other.to.x, other.from.y });
+    return (from > line.margin && to > line.margin && corner0 > line.margin && corner1 > line.margin) ||
+           (from < -line.margin && to < -line.margin && corner0 < -line.margin && corner1 < -line.margin);
+  };
+  return oneSide(first, second) || oneSide(second, first);
+}
+
+//Clips a line to a box, returning false if it misses.
+bool ClipLine(const Vector2& a, const Vector2& b, const Box& box, Vector2& from, Vector2& to) {
+  double t0 = 0, t1 = 1;
+  const double d[2] = { b.x - a.x, b.y - a.y };
+  const double start[2] = { a.x, a.y };
+  const double low[2] = { box.min.x, box.min.y };
+  const double high[2] = { box.max.x, box.max.y };
+  for(int axis = 0; axis < 2; ++axis) {
+    if(d[axis] == 0) {
+      if(start[axis] < low[axis] || start[axis] > high[axis])
+        return false;
+      continue;
+    }
+    double enter = (low[axis] - start[axis]) / d[axis];
+    double exit = (high[axis] - start[axis]) / d[axis];
+    if(enter > exit)
+      std::swap(enter, exit);
+    t0 = std::max(t0, enter);
+    t1 = std::min(t1, exit);
+  }
+  if(t0 > t1)
+    return false;
+  from = { a.x + d[0] * t0, a.y + d[1] * t0 };
+  to = { a.x + d[0] * t1, a.y + d[1] * t1 };
+  return true;
+}
+
+//Tests the pairs among the parts of one cell, adding both edges of every
+//pair in contact to found. The parts are swept across the mean direction of
+//the cell's lines, so the runs of nearly parallel lines that dense parts are
+//made of (gear flanks, hatching) each only meet their neighbours.
+void TestParts(const std::vector<CellPart>& parts, const std::vector<Shape>& shapes,
+               std::vector<Piece>& pieces, std::vector<uint32_t>& found) {
+  //The mean line direction: directions are summed with their angles doubled,
+  //so opposite directions agree, and the sum's angle halved.
+  Vector2 doubled = { 0, 0 };
+  for(const auto& part : parts) {
+    if(part.isBox)
+      continue;
+    const auto d = part.to - part.from;
+    const double length = sqrt(Dot(d, d));
+    if(length > 0)
+      doubled = { doubled.x + (d.x * d.x - d.y * d.y) / length, doubled.y + 2 * d.x * d.y / length };
+  }
+  Vector2 along = { 1, 0 };
+  const double doubledLength = sqrt(Dot(doubled, doubled));
+  if(doubledLength > 0) {
+    const double c = doubled.x / doubledLength;
+    along = { sqrt(std::max(0.0, (1 + c) / 2)), std::copysign(sqrt(std::max(0.0, (1 - c) / 2)), doubled.y) };
+  }
+  const Vector2 across = { -along.y, along.x };
+
+  pieces.clear();
+  for(size_t i = 0; i < parts.size(); ++i) {
+    const auto& part = parts[i];
+    Piece piece = { INFINITE, -INFINITE, INFINITE, -INFINITE, uint32_t(i) };
+    const auto add = [&](const Vector2& p) {
+      const double u = Dot(p, across), v = Dot(p, along);
+      piece.acrossMin = std::min(piece.acrossMin, u);
+      piece.acrossMax = std::max(piece.acrossMax, u);
+      piece.alongMin = std::min(piece.alongMin, v);
+      piece.alongMax = std::max(piece.alongMax, v);
+    };
+    add(part.from);
+    add(part.to);
+    if(part.isBox) {
+      add({ part.from.x, part.to.y });
+      add({ part.to.x, part.from.y });
+    }
+    piece.acrossMin -= CONTACT_TOLERANCE;
+    piece.acrossMax += CONTACT_TOLERANCE;
+    piece.alongMin -= CONTACT_TOLERANCE;
+    piece.alongMax += CONTACT_TOLERANCE;
+    pieces.push_back(piece);
+  }
+
+  std::sort(pieces.begin(), pieces.end(), [](const Piece& a, const Piece& b) { return a.acrossMin < b.acrossMin; });
+  for(size_t i = 0; i < pieces.size(); ++i) {
+    const auto& first = pieces[i];
+    for(size_t j = i + 1; j < pieces.size() && pieces[j].acrossMin <= first.acrossMax; ++j) {
+      const auto& second = pieces[j];
+      if(second.alongMin > first.alongMax || first.alongMin > second.alongMax ||
+         Separated(parts[first.part], parts[second.part]))
+        continue;
+      const uint32_t firstEdge = parts[first.part].edge, secondEdge = parts[second.part].edge;
+      if(firstEdge != secondEdge && InContact(shapes[firstEdge], shapes[secondEdge])) {
+        found.push_back(firstEdge);
+        found.push_back(secondEdge);
+      }
+    }
+  }
+}
+
+//Tests the cells of entries [begin, end), which starts and ends on cell
+//boundaries.
+void TestCells(const EdgeGrid& grid, const std::vector<Shape>& shapes, const std::vector<Box>& boxes,
+               size_t begin, size_t end, std::vector<uint32_t>& found) {
+  const auto& entries = grid.Entries();
+  std::vector<CellPart> parts;
+  std::vector<Piece> pieces;
+  while(begin < end) {
+    size_t cellEnd = begin + 1;
+    while(cellEnd < end && entries[cellEnd].cell == entries[begin].cell)
+      ++cellEnd;
+
+    if(cellEnd - begin < 2) {
+      begin = cellEnd;
+      continue;
+    }
+
+    //Parts are clipped to the cell grown by the tolerance, so that contacts
+    //on its border aren't cut off.
+    const Box cell = grid.CellBox(entries[begin].cell);
+    const Box clip = { { cell.min.x - CONTACT_TOLERANCE, cell.min.y - CONTACT_TOLERANCE },
+                       { cell.max.x + CONTACT_TOLERANCE, cell.max.y + CONTACT_TOLERANCE } };
+    parts.clear();
+    for(size_t i = begin; i < cellEnd; ++i) {
+      const uint32_t edge = entries[i].edge;
+      const auto& shape = shapes[edge];
+      Vector2 from, to;
+      if(!shape.IsArc() && ClipLine(shape.a, shape.b, clip, from, to)) {
+        parts.push_back(LinePart(edge, from, to));
+      }
+      else {
+        //Arcs, and lines that only come within the tolerance of the cell,
+        //are bounded by their box.
+        parts.push_back(BoxPart(edge, { std::max(boxes[edge].min.x, clip.min.x), std::max(boxes[edge].min.y, clip.min.y) },
+                                { std::min(boxes[edge].max.x, clip.max.x), std::min(boxes[edge].max.y, clip.max.y) }));
+      }
+    }
+    TestParts(parts, shapes, pieces, found);
+    begin = cellEnd;
+  }
+}
+
+}
+
+std::vector<uint32_t> FindIntersectingEdges(const IndexedPath& path, ThreadPool* pool) {
+  std::vector<Shape> shapes;
+  shapes.reserve(path.lines.size() + path.arcs.size());
+  for(const auto& line : path.lines)
+    shapes.push_back({ path.vertices[line.v0], path.vertices[line.v1], { 0, 0 }, 0, 0, 0 });
+  for(const auto& arc : path.arcs)
+    shapes.push_back(ArcShape(path.vertices[arc.v0], path.vertices[arc.v1], arc.center));
+
+  std::vector<Box> boxes(shapes.size());
+  for(size_t i = 0; i < shapes.size(); ++i)
+    boxes[i] = ShapeBox(shapes[i]);
+
+  const EdgeGrid grid(shapes, boxes);
+  const auto& entries = grid.Entries();
+
+  //A few runs of whole cells per thread so stealing can even out dense cells.
+  const size_t threads = pool ? pool->ThreadCount() : 1;
+  const size_t targetEntries = std::max<size_t>(1, entries.size() / (threads * 4));
+  std::vector<size_t> cuts = { 0 };
+  while(cuts.back() < entries.size()) {
+    size_t cut = std::min(entries.size(), cuts.back() + targetEntries);
+    while(cut < entries.size() && entries[cut].cell == entries[cut - 1].cell)
+      ++cut;
+    cuts.push_back(cut);
+  }
+
+  std::vector<std::vector<uint32_t>> found(cuts.size() - 1);
+  for(size_t i = 0; i + 1 < cuts.size(); ++i) {
+    if(pool && threads > 1)
+      pool->Submit([&, i] { TestCells(grid, shapes, boxes, cuts[i], cuts[i + 1], found[i]); });
+    else
+      TestCells(grid, shapes, boxes, cuts[i], cuts[i + 1], found[i]);
+  }
+  if(pool && threads > 1)
+    pool->Wait();
+
+  std::vector<uint32_t> edges;
+  for(const auto& run : found)
+    edges.insert(edges.end(), run.begin(), run.end());
+  std::sort(edges.begin(), edges.end());
+  edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+  return edges;
+}
+
+void ValidatePathGeometry(const IndexedPath& path, ThreadPool* pool) {
+  const auto edges = FindIntersectingEdges(path, pool);
+  if(edges.empty())
+    return;
+
+  std::ostringstream message;
+  message << "Path has " << edges.size() << " intersecting edges: ";
+  for(size_t i = 0; i < edges.size() && i < MAX_REPORTED_EDGES; ++i) {
+    if(i > 0)
+      message << ", ";
+    if(edges[i] < path.lines.size())
+      message << "line " << edges[i];
+    else
+      message << "arc " << edges[i] - path.lines.size();
+  }
+  if(edges.size() > MAX_REPORTED_EDGES)
+    message << " and " << edges.size() - MAX_REPORTED_EDGES << " more";
+  throw std::runtime_error(message.str());
+}
+
+void SetGeometryValidation(bool enabled) {
+  g_geometryValidation = enabled;
+}
+
+bool GeometryValidation() {
+  return g_geometryValidation.load(std::memory_order_relaxed);
+}
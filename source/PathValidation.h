@@ -0,0 +1,38 @@
+#pragma once
+
+#include "IndexedPath.h"
+
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+//Geometry checks for uploads whose edges cross or overlap, which would
+//otherwise be quoted as if the part were well formed.
+//
+//Edges are binned into a sparse uniform grid of radix sorted (cell, edge)
+//entries, with lines walked cell by cell and arcs taking their box. Each
+//cell sweeps the pieces of its edges across their mean direction, so only
+//nearby pieces are compared; pairs sharing several cells are found in each
+//and merged. What the sweep can't rule out is settled with exact line/line,
+//line/arc and arc/arc tests.
+//
+//Edges may meet at endpoints they share; any other contact within
+//CONTACT_TOLERANCE, including touching or running along one another, counts.
+
+const double CONTACT_TOLERANCE = 1e-7; //In inches
+
+//Edges that cross, touch or overlap another edge away from their shared
+//endpoints, sorted and numbered as in PathTopology: lines, then arcs. Cells
+//are tested across pool when one is given; it must not be called from one
+//of pool's threads.
+std::vector<uint32_t> FindIntersectingEdges(const IndexedPath& path, ThreadPool* pool);
+
+//Throws a runtime_error naming the edges FindIntersectingEdges reports, as
+//"line 3" or "arc 0" by their position among the path's lines and arcs.
+void ValidatePathGeometry(const IndexedPath& path, ThreadPool* pool);
+
+//Rejects quotes for paths that fail ValidatePathGeometry (cadquote
+//--validate-geometry). Off by default.
+void SetGeometryValidation(bool enabled);
+bool GeometryValidation();
@@ -0,0 +1,116 @@
+#include "Profile.h"
+
+#include <sys/resource.h>
+
+long PeakRssKb() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return usage.ru_maxrss / 1024;
+#else
+  return usage.ru_maxrss;
+#endif
+}
+
+#if CADQUOTE_PROFILE
+
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <sstream>
+
+#include <time.h>
+
+namespace {
+
+struct PhaseTotals {
+  double wall;
+  double cpu;
+  uint64_t calls;
+  uint64_t allocations;
+};
+
+const char* const PHASE_NAMES[] = { "read", "hash", "parse", "validate", "construct", "rapids", "oriented_bounds", "evaluate" };
+const char* const COUNTER_NAMES[] = { "bytes_read", "vertices", "lines", "arcs" };
+
+const size_t PHASE_COUNT = static_cast<size_t>(ProfilePhase::Count);
+const size_t COUNTER_COUNT = static_cast<size_t>(ProfileCounter::Count);
+
+static_assert(sizeof(PHASE_NAMES) / sizeof(PHASE_NAMES[0]) == PHASE_COUNT, "Every phase needs a name");
+static_assert(sizeof(COUNTER_NAMES) / sizeof(COUNTER_NAMES[0]) == COUNTER_COUNT, "Every counter needs a name");
+
+std::atomic<bool> g_enabled(false);
+std::mutex g_mutex;
+PhaseTotals g_phases[PHASE_COUNT];
+std::atomic<uint64_t> g_counters[COUNTER_COUNT];
+
+double WallSeconds() {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+double CpuSeconds(clockid_t clock) {
+  timespec now;
+  clock_gettime(clock, &now);
+  return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+}
+
+void EnableProfiling() {
+  g_enabled = true;
+}
+
+bool ProfilingEnabled() {
+  return g_enabled.load(std::memory_order_relaxed);
+}
+
+void ProfileCount(ProfileCounter counter, uint64_t value) {
+  if(ProfilingEnabled())
+    g_counters[static_cast<size_t>(counter)].fetch_add(value, std::memory_order_relaxed);
+}
+
+void ProfileScope::Start() {
+  m_allocations = AllocationCount();
+  m_cpu = CpuSeconds(CLOCK_THREAD_CPUTIME_ID);
+  m_wall = WallSeconds();
+}
+
+void ProfileScope::Stop() {
+  const double wall = WallSeconds() - m_wall;
+  const double cpu = CpuSeconds(CLOCK_THREAD_CPUTIME_ID) - m_cpu;
+  const uint64_t allocations = AllocationCount() - m_allocations;
+
+  std::lock_guard<std::mutex> lock(g_mutex);
+  auto& totals = g_phases[static_cast<size_t>(m_phase)];
+  totals.wall += wall;
+  totals.cpu += cpu;
+  ++totals.calls;
+  totals.allocations += allocations;
+}
+
+std::string ProfileJson() {
+  std::ostringstream out;
+  out << "{\"phases\":{";
+  {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    for(size_t i = 0; i < PHASE_COUNT; ++i) {
+      const auto& totals = g_phases[i];
+      out << (i == 0 ? "" : ",") << '"' << PHASE_NAMES[i] << "\":{\"wall_s\":" << totals.wall
+          << ",\"cpu_s\":" << totals.cpu << ",\"calls\":" << totals.calls
+          << ",\"allocs\":" << totals.allocations << '}';
+    }
+  }
+  out << '}';
+
+  for(size_t i = 0; i < COUNTER_COUNT; ++i)
+    out << ",\"" << COUNTER_NAMES[i] << "\":" << g_counters[i].load();
+
+  out << ",\"allocations\":" << AllocationCount()
+      << ",\"process_cpu_s\":" << CpuSeconds(CLOCK_PROCESS_CPUTIME_ID)
+      << ",\"peak_rss_kb\":" << PeakRssKb() << '}';
+  return out.str();
+}
+
+#endif
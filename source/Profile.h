@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+//Per phase timing and counters for cadquote --profile.
+//
+//Phases are marked with PROFILE_SCOPE and counts added with PROFILE_COUNT.
+//Both cost one flag check per phase until EnableProfiling is called, and
+//compile to nothing unless the build defines CADQUOTE_PROFILE, so the
+//instrumentation never touches per edge code.
+//
+//Wall time is summed over every scope of a phase. CPU time is that of the
+//thread running the scope, so work it hands to a pool (a parallel parse)
+//shows in wall time only; the process total is reported separately.
+//Allocation counts are process wide, so they are exact only while one
+//thread is quoting.
+
+#ifndef CADQUOTE_PROFILE
+#define CADQUOTE_PROFILE 0
+#endif
+
+enum class ProfilePhase {
+  Read, //Opening and mapping the file
+  Hash, //Hashing the document for the quote cache
+  Parse,
+  Validate, //Intersection checks, for --validate-geometry
+  Construct, //Building the ToolPath
+  Rapids, //Topology, rapid move planning and the kinematic cut sequence
+  OrientedBounds, //Hull and rotating calipers, for --oriented-bounds
+  Evaluate,
+  Count
+};
+
+enum class ProfileCounter {
+  BytesRead,
+  Vertices,
+  Lines,
+  Arcs,
+  Count
+};
+
+//Peak resident set size of the whole process so far, in kilobytes.
+long PeakRssKb();
+
+#if CADQUOTE_PROFILE
+
+void EnableProfiling();
+bool ProfilingEnabled();
+
+void ProfileCount(ProfileCounter counter, uint64_t value);
+
+class ProfileScope {
+public:
+  explicit ProfileScope(ProfilePhase phase) : m_phase(phase), m_active(ProfilingEnabled()) {
+    if(m_active)
+      Start();
+  }
+  ~ProfileScope() {
+    if(m_active)
+      Stop();
+  }
+
+  ProfileScope(const ProfileScope&) = delete;
+  ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+  void Start();
+  void Stop();
+
+  ProfilePhase m_phase;
+  bool m_active;
+  double m_wall, m_cpu;
+  uint64_t m_allocations;
+};
+
+//Everything recorded so far as one json object.
+std::string ProfileJson();
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(phase) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(ProfilePhase::phase)
+#define PROFILE_COUNT(counter, value) ProfileCount(ProfileCounter::counter, value)
+
+#else
+
+#define PROFILE_SCOPE(phase) ((void)0)
+#define PROFILE_COUNT(counter, value) ((void)0)
+
+#endif
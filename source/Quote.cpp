@@ -0,0 +1,210 @@
+#include "Quote.h"
+#include "MachineInfo.h"
+#include "MappedFile.h"
+#include "OrientedBounds.h"
+#include "PathValidation.h"
+#include "Profile.h"
+#include "QuoteCache.h"
+#include "RapidSequencing.h"
+#include "picojson.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <sstream>
+
+namespace {
+
+std::unique_ptr<MappedFile> MapDocument(const std::string& filename) {
+  PROFILE_SCOPE(Read);
+  std::unique_ptr<MappedFile> file(new MappedFile(filename));
+  PROFILE_COUNT(BytesRead, file->Size());
+  return file;
+}
+
+QuoteKey HashDocument(const char* data, size_t size) {
+  PROFILE_SCOPE(Hash);
+  return HashPathDocument(data, size);
+}
+
+//Returns the path's rapid distance. The cut sequence is laid out only for
+//the kinematic model, which is the only thing that reads it.
+double LoadPath(const char* data, size_t size, QuoteBuffers& buffers, bool kinematic) {
+  {
+    PROFILE_SCOPE(Parse);
+    if(buffers.pool)
+      buffers.loader.LoadParallel(data, size, buffers.indexed, *buffers.pool);
+    else
+      buffers.loader.Load(data, size, buffers.indexed);
+  }
+  PROFILE_COUNT(Vertices, buffers.indexed.vertices.size());
+  PROFILE_COUNT(Lines, buffers.indexed.lines.size());
+  PROFILE_COUNT(Arcs, buffers.indexed.arcs.size());
+
+  if(GeometryValidation()) {
+    PROFILE_SCOPE(Validate);
+    ValidatePathGeometry(buffers.indexed, buffers.pool);
+  }
+
+  {
+    PROFILE_SCOPE(Construct);
+    MakeToolPath(buffers.indexed, buffers.path);
+  }
+
+  if(OrientedPricing()) {
+    PROFILE_SCOPE(OrientedBounds);
+    buffers.orientedBounds = ComputeOrientedBounds(buffers.indexed).size;
+  }
+  else {
+    const double infinity = std::numeric_limits<double>::infinity();
+    buffers.orientedBounds = { infinity, infinity };
+  }
+
+  PROFILE_SCOPE(Rapids);
+  if(kinematic)
+    return PlanCutSequence(buffers.indexed, buffers.cuts);
+  buffers.cuts.Clear();
+  return PlanRapidDistance(buffers.indexed);
+}
+
+PathMetrics EvaluatePath(const ToolPath& path) {
+  PROFILE_SCOPE(Evaluate);
+  return path.Evaluate();
+}
+
+PathEvaluation EvaluateLoaded(const MachineInfo& tooling, const ToolPath& path, const CutSequence& cuts,
+                              double rapidDistance, const Vector2& orientedBounds) {
+  PathEvaluation evaluation;
+  evaluation.metrics = EvaluatePath(path);
+  evaluation.rapidDistance = rapidDistance;
+  evaluation.orientedBounds = orientedBounds;
+  evaluation.cutTime = ComputeCutTime(tooling, cuts, evaluation.metrics.travel, rapidDistance);
+  return evaluation;
+}
+
+Quote CostEvaluation(const MachineInfo& tooling, const PathEvaluation& evaluation) {
+  const auto bounds = ChargedBounds(tooling, evaluation.metrics.Bounds(), evaluation.orientedBounds);
+  return { evaluation.cutTime, ComputeCost(tooling, bounds, evaluation.cutTime) };
+}
+
+}
+
+Quote ComputeQuote(const MachineInfo& tooling, const ToolPath& path, const CutSequence& cuts,
+                   double rapidDistance, const Vector2& orientedBounds) {
+  return CostEvaluation(tooling, EvaluateLoaded(tooling, path, cuts, rapidDistance, orientedBounds));
+}
+
+PathEvaluation EvaluateDocument(const MachineInfo& tooling, const char* data, size_t size, QuoteBuffers& buffers) {
+  const double rapidDistance = LoadPath(data, size, buffers, tooling.acceleration > 0);
+  return EvaluateLoaded(tooling, buffers.path, buffers.cuts, rapidDistance, buffers.orientedBounds);
+}
+
+PathEvaluation EvaluateFile(const MachineInfo& tooling, const std::string& filename, QuoteBuffers& buffers) {
+  const auto file = MapDocument(filename);
+  return EvaluateDocument(tooling, file->Data(), file->Size(), buffers);
+}
+
+void ComputeQuotes(const ToolingCatalog& catalog, const PathMetrics& metrics, const CutSequence& cuts,
+                   double rapidDistance, const Vector2& orientedBounds, Quote* out) {
+  const auto bounds = metrics.Bounds();
+  const double* padding = catalog.padding.data();
+  const double* maxSpeed = catalog.maxSpeed.data();
+  const double* costPerS = catalog.costPerS.data();
+  const double* costPerSqIn = catalog.costPerSqIn.data();
+  const double* rapidSpeed = catalog.rapidSpeed.data();
+
+  //Same operations in the same order as ComputeCutTime, ChargedBounds and
+  //ComputeCost, as a branch free loop over the parallel arrays that the
+  //compiler vectorizes.
+  const size_t count = catalog.Size();
+  for(size_t i = 0; i < count; ++i) {
+    const double cutTime = metrics.travel / maxSpeed[i] + rapidDistance / rapidSpeed[i];
+    const double alignedArea = (bounds.x + padding[i]) * (bounds.y + padding[i]);
+    const double orientedArea = (orientedBounds.x + padding[i]) * (orientedBounds.y + padding[i]);
+    const double area = orientedArea < alignedArea ? orientedArea : alignedArea;
+    out[i].cutTime = cutTime;
+    out[i].cost = (area * costPerSqIn[i]) + (cutTime * costPerS[i]);
+  }
+
+  //Machines with an acceleration are retimed with a planner pass each.
+  for(size_t i = 0; i < count; ++i) {
+    if(catalog.acceleration[i] > 0) {
+      const auto tooling = catalog.Get(i);
+      out[i].cutTime = ComputeCutTime(tooling, cuts, metrics.travel, rapidDistance);
+      out[i].cost = ComputeCost(tooling, ChargedBounds(tooling, bounds, orientedBounds), out[i].cutTime);
+    }
+  }
+}
+
+Quote QuoteDocument(const MachineInfo& tooling, const char* data, size_t size,
+                    QuoteBuffers& buffers, QuoteCache* cache) {
+  QuoteKey key;
+  Quote quote;
+  if(cache) {
+    key = MakeQuoteKey(HashDocument(data, size), tooling);
+    if(cache->Find(key, quote))
+      return quote;
+  }
+
+  quote = CostEvaluation(tooling, EvaluateDocument(tooling, data, size, buffers));
+
+  if(cache)
+    cache->Insert(key, quote);
+  return quote;
+}
+
+Quote QuoteFile(const MachineInfo& tooling, const std::string& filename,
+                QuoteBuffers& buffers, QuoteCache* cache) {
+  const auto file = MapDocument(filename);
+  return QuoteDocument(tooling, file->Data(), file->Size(), buffers, cache);
+}
+
+void QuoteDocument(const ToolingCatalog& catalog, const char* data, size_t size,
+                   QuoteBuffers& buffers, QuoteCache* cache, std::vector<Quote>& quotes) {
+  quotes.resize(catalog.Size());
+
+  //Only a table that is cached in full skips the parse.
+  std::vector<QuoteKey> keys;
+  if(cache) {
+    const auto document = HashDocument(data, size);
+    bool allFound = true;
+    for(size_t i = 0; i < catalog.Size(); ++i) {
+      keys.push_back(MakeQuoteKey(document, catalog.Get(i)));
+      allFound = cache->Find(keys.back(), quotes[i]) && allFound;
+    }
+    if(allFound)
+      return;
+  }
+
+  const bool kinematic = std::any_of(catalog.acceleration.begin(), catalog.acceleration.end(),
+                                     [](double acceleration) { return acceleration > 0; });
+  const double rapidDistance = LoadPath(data, size, buffers, kinematic);
+  ComputeQuotes(catalog, EvaluatePath(buffers.path), buffers.cuts, rapidDistance, buffers.orientedBounds, quotes.data());
+
+  if(cache)
+    for(size_t i = 0; i < catalog.Size(); ++i)
+      cache->Insert(keys[i], quotes[i]);
+}
+
+void QuoteFile(const ToolingCatalog& catalog, const std::string& filename,
+               QuoteBuffers& buffers, QuoteCache* cache, std::vector<Quote>& quotes) {
+  const auto file = MapDocument(filename);
+  QuoteDocument(catalog, file->Data(), file->Size(), buffers, cache, quotes);
+}
+
+std::string QuoteJsonFields(const Quote& quote) {
+  std::ostringstream out;
+  out << "\"cut_time\":" << quote.cutTime << ",\"cost\":" << std::fixed << std::setprecision(2) << quote.cost;
+  return out.str();
+}
+
+std::string QuoteTableJson(const ToolingCatalog& catalog, const std::vector<Quote>& quotes) {
+  std::string table = "[";
+  for(size_t i = 0; i < quotes.size(); ++i) {
+    if(i > 0)
+      table += ',';
+    table += "{\"machine\":" + picojson::value(catalog.names[i]).serialize() + "," + QuoteJsonFields(quotes[i]) + "}";
+  }
+  return table + "]";
+}
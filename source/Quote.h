@@ -0,0 +1,82 @@
+#pragma once
+
+#include "IndexedPath.h"
+#include "MotionPlanner.h"
+#include "PathLoader.h"
+#include "ToolPath.h"
+#include "ToolingCatalog.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+struct MachineInfo;
+class QuoteCache;
+class ThreadPool;
+
+//Result of quoting a single tool path on a single machine.
+struct Quote {
+  double cutTime; //In seconds
+  double cost; //In dollars
+};
+
+//rapidDistance is the travel between contours, see PlanRapidDistance. cuts
+//is only read when the machine has an acceleration, see PlanCutSequence.
+//Material is charged by orientedBounds where that is cheaper, see
+//ChargedBounds; pass infinite bounds to always use the axis aligned ones.
+Quote ComputeQuote(const MachineInfo& tooling, const ToolPath& path, const CutSequence& cuts,
+                   double rapidDistance, const Vector2& orientedBounds);
+
+//Quotes one evaluated path on every catalog entry at once. out must hold
+//catalog.Size() quotes. Each matches ComputeQuote for that entry exactly.
+void ComputeQuotes(const ToolingCatalog& catalog, const PathMetrics& metrics, const CutSequence& cuts,
+                   double rapidDistance, const Vector2& orientedBounds, Quote* out);
+
+//Scratch storage for quoting many documents on one thread.
+struct QuoteBuffers {
+  PathLoader loader;
+  IndexedPath indexed;
+  ToolPath path;
+  CutSequence cuts; //Only laid out for machines with an acceleration
+  Vector2 orientedBounds; //Size of the oriented box, or infinite unless OrientedPricing()
+
+  //When set, large documents are parsed in parallel on this pool. Leave it
+  //null when quoting from inside a pool task.
+  ThreadPool* pool = nullptr;
+};
+
+//A path loaded, evaluated and timed on one machine: everything its quote
+//is computed from. Nested batches, which charge material by sheet rather
+//than by bounds, start from this instead of a Quote.
+struct PathEvaluation {
+  PathMetrics metrics;
+  double rapidDistance;
+  Vector2 orientedBounds; //Infinite unless OrientedPricing()
+  double cutTime; //In seconds
+};
+
+//Loads a json or binary path document and runs every quoting phase but
+//the costing, with the same profile counters as a quote. Never cached.
+PathEvaluation EvaluateDocument(const MachineInfo& tooling, const char* data, size_t size, QuoteBuffers& buffers);
+PathEvaluation EvaluateFile(const MachineInfo& tooling, const std::string& filename, QuoteBuffers& buffers);
+
+//Quotes a json or binary path document held in memory. With a cache, the
+//document bytes are hashed first and a known part is never parsed.
+Quote QuoteDocument(const MachineInfo& tooling, const char* data, size_t size,
+                    QuoteBuffers& buffers, QuoteCache* cache);
+Quote QuoteFile(const MachineInfo& tooling, const std::string& filename,
+                QuoteBuffers& buffers, QuoteCache* cache);
+
+//Quote tables: the path is loaded and evaluated once, then quoted on every
+//catalog entry. quotes is resized to catalog.Size().
+void QuoteDocument(const ToolingCatalog& catalog, const char* data, size_t size,
+                   QuoteBuffers& buffers, QuoteCache* cache, std::vector<Quote>& quotes);
+void QuoteFile(const ToolingCatalog& catalog, const std::string& filename,
+               QuoteBuffers& buffers, QuoteCache* cache, std::vector<Quote>& quotes);
+
+//The quote as the body of a json object, e.g. "cut_time":32,"cost":14.10
+//The cost is rounded to cents like the command line output.
+std::string QuoteJsonFields(const Quote& quote);
+
+//The table as a json array of {"machine":..,"cut_time":..,"cost":..}.
+std::string QuoteTableJson(const ToolingCatalog& catalog, const std::vector<Quote>& quotes);
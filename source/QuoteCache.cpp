@@ -0,0 +1,237 @@
+#include "QuoteCache.h"
+#include "MachineInfo.h"
+#include "OrientedBounds.h"
+#include "PathBinary.h"
+#include "PathValidation.h"
+#include "ToolPath.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+#include <unistd.h>
+
+namespace {
+
+//Bump both whenever the same part and machine can quote differently, e.g. a
+//change to how cut time or material is charged, so older records on disk
+//are never served as hits.
+const uint32_t QUOTE_MODEL_VERSION = 2;
+const char RECORD_MAGIC[4] = { 'C', 'Q', 'Q', '2' };
+
+uint64_t Rotl(uint64_t x, int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+uint64_t Mix(uint64_t x) {
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdull;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ull;
+  x ^= x >> 33;
+  return x;
+}
+
+//Two lane multiply-rotate hash in the style of MurmurHash3's x64_128.
+//Bytes are gathered into 8 byte words so the whitespace filter can feed it
+//one byte at a time.
+class ContentHasher {
+public:
+  ContentHasher(uint64_t seed = 0) : m_h1(seed), m_h2(seed ^ 0x9e3779b97f4a7c15ull) {}
+
+  void Byte(unsigned char c) {
+    m_word |= uint64_t(c) << (8 * (m_length & 7));
+    if((++m_length & 7) == 0)
+      Flush();
+  }
+
+  void Bytes(const void* data, size_t size) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for(size_t i = 0; i < size; ++i)
+      Byte(bytes[i]);
+  }
+
+  QuoteKey Finish() {
+    if(m_length & 7)
+      Flush();
+    m_h1 ^= m_length;
+    m_h2 ^= m_length;
+    m_h1 += m_h2;
+    m_h2 += m_h1;
+    m_h1 = Mix(m_h1);
+    m_h2 = Mix(m_h2);
+    m_h1 += m_h2;
+    m_h2 += m_h1;
+    return { m_h1, m_h2 };
+  }
+
+private:
+  void Flush() {
+    const uint64_t c1 = 0x87c37b91114253d5ull, c2 = 0x4cf5ad432745937full;
+    m_h1 ^= Rotl(m_word * c1, 31) * c2;
+    m_h1 = Rotl(m_h1, 27) + m_h2;
+    m_h1 = m_h1 * 5 + 0x52dce729;
+    m_h2 ^= Rotl(m_word * c2, 33) * c1;
+    m_h2 = Rotl(m_h2, 31) + m_h1;
+    m_h2 = m_h2 * 5 + 0x38495ab5;
+    m_word = 0;
+  }
+
+  uint64_t m_h1, m_h2;
+  uint64_t m_word = 0;
+  uint64_t m_length = 0;
+};
+
+}
+
+std::string QuoteKey::ToHex() const {
+  char buf[33];
+  snprintf(buf, sizeof(buf), "%016llx%016llx",
+           static_cast<unsigned long long>(hi), static_cast<unsigned long long>(lo));
+  return buf;
+}
+
+QuoteKey HashPathDocument(const char* data, size_t size) {
+  ContentHasher hasher;
+
+  if(IsBinaryPath(data, size)) {
+    hasher.Bytes(data, size);
+    return hasher.Finish();
+  }
+
+  bool inString = false;
+  bool escaped = false;
+  for(size_t i = 0; i < size; ++i) {
+    const char c = data[i];
+    if(inString) {
+      if(escaped)
+        escaped = false;
+      else if(c == '\\')
+        escaped = true;
+      else if(c == '"')
+        inString = false;
+    }
+    else if(c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+      continue;
+    }
+    else if(c == '"') {
+      inString = true;
+    }
+    hasher.Byte(static_cast<unsigned char>(c));
+  }
+
+  return hasher.Finish();
+}
+
+QuoteKey MakeQuoteKey(const QuoteKey& document, const MachineInfo& tooling) {
+  ContentHasher hasher(document.hi);
+  hasher.Bytes(&document.lo, sizeof(document.lo));
+  hasher.Bytes(&QUOTE_MODEL_VERSION, sizeof(QUOTE_MODEL_VERSION));
+  for(double parameter : { tooling.padding, tooling.max_speed, tooling.cost_per_s, tooling.cost_per_sq_in,
+                           tooling.rapid_speed, tooling.acceleration, tooling.junction_deviation })
+    hasher.Bytes(&parameter, sizeof(parameter));
+  hasher.Byte(FastArcMath() ? 1 : 0);
+  hasher.Byte(OrientedPricing() ? 1 : 0);
+  hasher.Byte(GeometryValidation() ? 1 : 0);
+  return hasher.Finish();
+}
+
+QuoteCache::QuoteCache(size_t capacity, const std::string& directory)
+  : m_capacity(capacity), m_directory(directory), m_stats{0, 0, 0} {}
+
+std::string QuoteCache::RecordPath(const QuoteKey& key) const {
+  return m_directory + "/" + key.ToHex() + ".quote";
+}
+
+bool QuoteCache::Find(const QuoteKey& key, Quote& out) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto found = m_index.find(key);
+    if(found != m_index.end()) {
+      m_lru.splice(m_lru.begin(), m_lru, found->second);
+      out = found->second->second;
+      ++m_stats.memoryHits;
+      return true;
+    }
+  }
+
+  if(!m_directory.empty()) {
+    std::ifstream record(RecordPath(key), std::ios::binary);
+    char magic[sizeof(RECORD_MAGIC)];
+    Quote quote;
+    if(record.read(magic, sizeof(magic)) &&
+       memcmp(magic, RECORD_MAGIC, sizeof(magic)) == 0 &&
+       record.read(reinterpret_cast<char*>(&quote.cutTime), sizeof(quote.cutTime)) &&
+       record.read(reinterpret_cast<char*>(&quote.cost), sizeof(quote.cost))) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      InsertMemory(key, quote);
+      ++m_stats.diskHits;
+      out = quote;
+      return true;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  ++m_stats.misses;
+  return false;
+}
+
+void QuoteCache::Insert(const QuoteKey& key, const Quote& quote) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    InsertMemory(key, quote);
+  }
+
+  if(m_directory.empty())
+    return;
+
+  //Written under a temporary name unique to this process and thread, then
+  //renamed into place, so a concurrent reader never sees a partial record
+  //even when several servers share the directory.
+  const auto path = RecordPath(key);
+  const auto temporary = path + ".tmp" + std::to_string(getpid()) + "." +
+    std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+  {
+    std::ofstream record(temporary, std::ios::binary);
+    record.write(RECORD_MAGIC, sizeof(RECORD_MAGIC));
+    record.write(reinterpret_cast<const char*>(&quote.cutTime), sizeof(quote.cutTime));
+    record.write(reinterpret_cast<const char*>(&quote.cost), sizeof(quote.cost));
+    if(!record) {
+      std::remove(temporary.c_str());
+      return;
+    }
+  }
+  std::rename(temporary.c_str(), path.c_str());
+}
+
+void QuoteCache::InsertMemory(const QuoteKey& key, const Quote& quote) {
+  if(m_capacity == 0)
+    return;
+
+  const auto found = m_index.find(key);
+  if(found != m_index.end()) {
+    found->second->second = quote;
+    m_lru.splice(m_lru.begin(), m_lru, found->second);
+    return;
+  }
+
+  if(m_lru.size() >= m_capacity) {
+    m_index.erase(m_lru.back().first);
+    m_lru.pop_back();
+  }
+
+  m_lru.emplace_front(key, quote);
+  m_index[key] = m_lru.begin();
+}
+
+QuoteCache::Stats QuoteCache::GetStats() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_stats;
+}
+
+std::string QuoteCacheStatsJson(const QuoteCache::Stats& stats) {
+  return "{\"memory_hits\":" + std::to_string(stats.memoryHits) +
+         ",\"disk_hits\":" + std::to_string(stats.diskHits) +
+         ",\"misses\":" + std::to_string(stats.misses) + "}";
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Quote.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+struct MachineInfo;
+
+//128 bit content address of a (path document, machine) pair.
+struct QuoteKey {
+  uint64_t hi, lo;
+
+  bool operator==(const QuoteKey& other) const { return hi == other.hi && lo == other.lo; }
+  std::string ToHex() const;
+};
+
+//Hashes a json or binary path document. For json, whitespace outside of
+//strings is skipped, so re-indented or re-wrapped exports of the same part
+//share a key; key order and number spelling still matter.
+//Non-cryptographic: only suitable for content we already trust.
+QuoteKey HashPathDocument(const char* data, size_t size);
+
+//Folds the quote model version, the machine parameters, and whether the
+//fast arc math, oriented pricing and geometry validation are on, into a
+//document hash.
+QuoteKey MakeQuoteKey(const QuoteKey& document, const MachineInfo& tooling);
+
+//Thread safe quote cache with an in-memory LRU tier and an optional
+//on-disk tier holding one small record file per key.
+//Entries are never invalidated: a key fully determines its quote.
+class QuoteCache {
+public:
+  struct Stats {
+    uint64_t memoryHits;
+    uint64_t diskHits;
+    uint64_t misses;
+  };
+
+  //capacity is in entries; 0 disables the memory tier. An empty
+  //directory disables the disk tier. The directory must already exist.
+  QuoteCache(size_t capacity, const std::string& directory);
+
+  bool Find(const QuoteKey& key, Quote& out);
+  void Insert(const QuoteKey& key, const Quote& quote);
+
+  Stats GetStats() const;
+
+private:
+  struct KeyHash {
+    size_t operator()(const QuoteKey& key) const { return static_cast<size_t>(key.lo); }
+  };
+  typedef std::list<std::pair<QuoteKey,Quote>> LruList;
+
+  void InsertMemory(const QuoteKey& key, const Quote& quote);
+  std::string RecordPath(const QuoteKey& key) const;
+
+  const size_t m_capacity;
+  const std::string m_directory;
+
+  mutable std::mutex m_mutex;
+  LruList m_lru; //most recently used first
+  std::unordered_map<QuoteKey, LruList::iterator, KeyHash> m_index;
+  Stats m_stats;
+};
+
+//{"memory_hits":..,"disk_hits":..,"misses":..}
+std::string QuoteCacheStatsJson(const QuoteCache::Stats& stats);
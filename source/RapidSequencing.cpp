@@ -0,0 +1,538 @@
+#include "RapidSequencing.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <limits>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const uint32_t NONE = UINT32_MAX;
+
+//How many nearby contours each contour tries moves against.
+const size_t NEIGHBOURS = 8;
+
+//Default improvement visits per contour. Grid-like parts settle in about
+//one; the rest is headroom for scattered ones.
+const size_t VISITS_PER_CONTOUR = 16;
+
+//Moves must gain at least this much, so rounding can't make them cycle.
+const double IMPROVEMENT = 1e-9;
+
+double SquaredDistance(const Vector2& a, const Vector2& b) {
+  const auto diff = b - a;
+  return Dot(diff, diff);
+}
+
+//Static 2d tree stored implicitly: the node for [lo, hi) is the point at
+//(lo + hi) / 2, split on x at even depths and y at odd ones. Points can be
+//removed; each node counts the live points under it so empty subtrees are
+//skipped.
+class PointTree {
+public:
+  struct Point {
+    Vector2 position;
+    uint32_t id;
+  };
+
+  explicit PointTree(std::vector<Point> points)
+    : m_points(std::move(points)), m_live(m_points.size(), 0), m_dead(m_points.size(), 0) {
+    Build(0, m_points.size(), 0);
+  }
+
+  const Point& At(size_t index) const { return m_points[index]; }
+  size_t Size() const { return m_points.size(); }
+
+  void Remove(size_t index) {
+    if(m_dead[index])
+      return;
+    m_dead[index] = 1;
+
+    size_t lo = 0;
+    size_t hi = m_points.size();
+    while(lo < hi) {
+      const size_t mid = (lo + hi) / 2;
+      --m_live[mid];
+      if(index == mid)
+        break;
+      if(index < mid)
+        hi = mid;
+      else
+        lo = mid + 1;
+    }
+  }
+
+  //Index of the nearest live point, or NONE if every point was removed.
+  size_t Nearest(const Vector2& query) const {
+    size_t best = NONE;
+    double bestDistance = std::numeric_limits<double>::infinity();
+    Nearest(query, 0, m_points.size(), 0, best, bestDistance);
+    return best;
+  }
+
+  //Up to count nearest points, closest first; removed points are ignored.
+  void KNearest(const Vector2& query, size_t count, std::vector<std::pair<double, size_t>>& out) const {
+    out.clear();
+    KNearest(query, count, 0, m_points.size(), 0, out);
+    std::sort(out.begin(), out.end());
+  }
+
+private:
+  static double Axis(const Vector2& v, size_t depth) { return depth % 2 == 0 ? v.x : v.y; }
+
+  void Build(size_t lo, size_t hi, size_t depth) {
+    if(lo >= hi)
+      return;
+    const size_t mid = (lo + hi) / 2;
+    std::nth_element(m_points.begin() + lo, m_points.begin() + mid, m_points.begin() + hi,
+                     [depth](const Point& a, const Point& b) { return Axis(a.position, depth) < Axis(b.position, depth); });
+    m_live[mid] = static_cast<uint32_t>(hi - lo);
+    Build(lo, mid, depth + 1);
+    Build(mid + 1, hi, depth + 1);
+  }
+
+  void Nearest(const Vector2& query, size_t lo, size_t hi, size_t depth, size_t& best, double& bestDistance) const {
+    if(lo >= hi)
+      return;
+    const size_t mid = (lo + hi) / 2;
+    if(m_live[mid] == 0)
+      return;
+
+    const auto& point = m_points[mid];
+    if(!m_dead[mid]) {
+      const double distance = SquaredDistance(query, point.position);
+      if(distance < bestDistance) {
+        bestDistance = distance;
+        best = mid;
+      }
+    }
+
+    const double offset = Axis(query, depth) - Axis(point.position, depth);
+    if(offset < 0) {
+      Nearest(query, lo, mid, depth + 1, best, bestDistance);
+      if(offset * offset < bestDistance)
+        Nearest(query, mid + 1, hi, depth + 1, best, bestDistance);
+    }
+    else {
+      Nearest(query, mid + 1, hi, depth + 1, best, bestDistance);
+      if(offset * offset < bestDistance)
+        Nearest(query, lo, mid, depth + 1, best, bestDistance);
+    }
+  }
+
+  //out is kept as a max heap on distance while searching.
+  void KNearest(const Vector2& query, size_t count, size_t lo, size_t hi, size_t depth,
+                std::vector<std::pair<double, size_t>>& out) const {
+    if(lo >= hi)
+      return;
+    const size_t mid = (lo + hi) / 2;
+    if(m_live[mid] == 0)
+      return;
+
+    const auto& point = m_points[mid];
+    if(!m_dead[mid]) {
+      const double distance = SquaredDistance(query, point.position);
+      if(out.size() < count) {
+        out.push_back({ distance, mid });
+        std::push_heap(out.begin(), out.end());
+      }
+      else if(distance < out.front().first) {
+        std::pop_heap(out.begin(), out.end());
+        out.back() = { distance, mid };
+        std::push_heap(out.begin(), out.end());
+      }
+    }
+
+    const double offset = Axis(query, depth) - Axis(point.position, depth);
+    const size_t nearLo = offset < 0 ? lo : mid + 1;
+    const size_t nearHi = offset < 0 ? mid : hi;
+    const size_t farLo = offset < 0 ? mid + 1 : lo;
+    const size_t farHi = offset < 0 ? hi : mid;
+    KNearest(query, count, nearLo, nearHi, depth + 1, out);
+    if(out.size() < count || offset * offset < out.front().first)
+      KNearest(query, count, farLo, farHi, depth + 1, out);
+  }
+
+  std::vector<Point> m_points;
+  std::vector<uint32_t> m_live;
+  std::vector<uint8_t> m_dead;
+};
+
+//The tour being improved. Slot i holds contour order[i], entered at in(i)
+//and left at out(i); reversing a stretch of the tour swaps the ends of the
+//open chains in it.
+class Tour {
+public:
+  Tour(const std::vector<Vector2>& first, const std::vector<Vector2>& last,
+       std::vector<uint32_t> order, std::vector<uint8_t>& reversed)
+    : m_first(first), m_last(last), m_order(std::move(order)), m_reversed(reversed), m_slot(m_order.size()) {
+    for(size_t i = 0; i < m_order.size(); ++i)
+      m_slot[m_order[i]] = static_cast<uint32_t>(i);
+  }
+
+  size_t Size() const { return m_order.size(); }
+  uint32_t Slot(uint32_t contour) const { return m_slot[contour]; }
+  const std::vector<uint32_t>& Order() const { return m_order; }
+
+  const Vector2& In(size_t slot) const {
+    const uint32_t c = m_order[slot];
+    return m_reversed[c] ? m_last[c] : m_first[c];
+  }
+  const Vector2& Out(size_t slot) const {
+    const uint32_t c = m_order[slot];
+    return m_reversed[c] ? m_first[c] : m_last[c];
+  }
+
+  //Contours at the ends of the legs the last applied move changed.
+  const std::vector<uint32_t>& Touched() const { return m_touched; }
+
+  //Rapid leg from slot to slot + 1.
+  double Leg(size_t slot) const {
+    return slot + 1 < m_order.size() ? Distance(Out(slot), In(slot + 1)) : 0;
+  }
+
+  //2-opt: reverse slots (i, j], replacing legs i and j. i may be -1 to
+  //reverse a prefix, and j the last slot to reverse a suffix.
+  bool TryTwoOpt(long i, size_t j) {
+    const size_t first = static_cast<size_t>(i + 1);
+    if(first >= j)
+      return false;
+
+    //After the reversal slot first is entered at Out(j), and slot j is left at In(first).
+    double before = 0;
+    double after = 0;
+    if(i >= 0) {
+      before += Distance(Out(i), In(first));
+      after += Distance(Out(i), Out(j));
+    }
+    if(j + 1 < m_order.size()) {
+      before += Distance(Out(j), In(j + 1));
+      after += Distance(In(first), In(j + 1));
+    }
+    if(after >= before - IMPROVEMENT)
+      return false;
+
+    m_touched.clear();
+    if(i >= 0)
+      Touch(i);
+    Touch(first);
+    Touch(j);
+    Touch(j + 1);
+
+    std::reverse(m_order.begin() + first, m_order.begin() + j + 1);
+    for(size_t k = first; k <= j; ++k) {
+      m_reversed[m_order[k]] ^= 1;
+      m_slot[m_order[k]] = static_cast<uint32_t>(k);
+    }
+    return true;
+  }
+
+  //Or-opt: move slots [s, s + length) to just after slot target, in either
+  //direction.
+  bool TryOrOpt(size_t s, size_t length, size_t target) {
+    const size_t e = s + length - 1;
+    if(e >= m_order.size() || (target + 1 >= s && target <= e))
+      return false;
+
+    //Closing the gap the segment leaves.
+    double removed = 0;
+    double added = 0;
+    if(s > 0)
+      removed += Distance(Out(s - 1), In(s));
+    if(e + 1 < m_order.size())
+      removed += Distance(Out(e), In(e + 1));
+    if(s > 0 && e + 1 < m_order.size())
+      added += Distance(Out(s - 1), In(e + 1));
+
+    //Opening a gap after target.
+    const bool hasNext = target + 1 < m_order.size();
+    const Vector2& targetOut = Out(target);
+    if(hasNext)
+      removed += Distance(targetOut, In(target + 1));
+
+    double forward = added + Distance(targetOut, In(s));
+    double backward = added + Distance(targetOut, Out(e));
+    if(hasNext) {
+      forward += Distance(Out(e), In(target + 1));
+      backward += Distance(In(s), In(target + 1));
+    }
+
+    const bool reverse = backward < forward;
+    if(std::min(forward, backward) >= removed - IMPROVEMENT)
+      return false;
+
+    m_touched.clear();
+    if(s > 0)
+      Touch(s - 1);
+    Touch(s);
+    Touch(e);
+    Touch(e + 1);
+    Touch(target);
+    Touch(target + 1);
+
+    if(reverse) {
+      std::reverse(m_order.begin() + s, m_order.begin() + e + 1);
+      for(size_t k = s; k <= e; ++k)
+        m_reversed[m_order[k]] ^= 1;
+    }
+
+    size_t lo, hi;
+    if(target > e) {
+      std::rotate(m_order.begin() + s, m_order.begin() + e + 1, m_order.begin() + target + 1);
+      lo = s;
+      hi = target;
+    }
+    else {
+      std::rotate(m_order.begin() + target + 1, m_order.begin() + s, m_order.begin() + e + 1);
+      lo = target + 1;
+      hi = e;
+    }
+    for(size_t k = lo; k <= hi; ++k)
+      m_slot[m_order[k]] = static_cast<uint32_t>(k);
+    return true;
+  }
+
+private:
+  void Touch(size_t slot) {
+    if(slot < m_order.size())
+      m_touched.push_back(m_order[slot]);
+  }
+
+  const std::vector<Vector2>& m_first;
+  const std::vector<Vector2>& m_last;
+  std::vector<uint32_t> m_order;
+  std::vector<uint8_t>& m_reversed;
+  std::vector<uint32_t> m_slot;
+  std::vector<uint32_t> m_touched;
+};
+
+double TourDistance(const Tour& tour) {
+  double total = 0;
+  for(size_t i = 0; i + 1 < tour.Size(); ++i)
+    total += tour.Leg(i);
+  return total;
+}
+
+}
+
+RapidOptions DefaultRapidOptions() {
+  return { { 0, 0 }, VISITS_PER_CONTOUR, std::numeric_limits<double>::infinity() };
+}
+
+RapidPlan PlanRapidMoves(const IndexedPath& path, const PathTopology& topology, const RapidOptions& options) {
+  const auto started = Clock::now();
+  const size_t contourCount = topology.ContourCount();
+
+  RapidPlan plan;
+  plan.entry.assign(contourCount, 0);
+  plan.reversed.assign(contourCount, 0);
+  plan.rapidDistance = 0;
+  plan.nearestNeighbourDistance = 0;
+  if(contourCount == 0)
+    return plan;
+
+  //Vertices of each contour in walk order; an open chain's last one is its far end.
+  std::vector<uint32_t> vertexOffsets(contourCount + 1, 0);
+  std::vector<uint32_t> vertices;
+  vertices.reserve(topology.contourHalfEdges.size() + contourCount);
+  for(size_t c = 0; c < contourCount; ++c) {
+    vertexOffsets[c] = static_cast<uint32_t>(vertices.size());
+    vertices.push_back(topology.contourStart[c]);
+    //A closed contour's last edge comes back to the start, which is already listed.
+    const uint32_t end = topology.contourOffsets[c + 1] - (topology.contourClosed[c] ? 1 : 0);
+    for(uint32_t i = topology.contourOffsets[c]; i < end; ++i)
+      vertices.push_back(topology.Target(path, topology.contourHalfEdges[i]));
+  }
+  vertexOffsets[contourCount] = static_cast<uint32_t>(vertices.size());
+
+  //Entry candidates: every vertex of a closed contour, both ends of an open one.
+  std::vector<PointTree::Point> candidates;
+  candidates.reserve(vertices.size());
+  std::vector<uint32_t> candidateVertex;
+  candidateVertex.reserve(vertices.size());
+  for(uint32_t c = 0; c < contourCount; ++c) {
+    const uint32_t begin = vertexOffsets[c];
+    const uint32_t end = vertexOffsets[c + 1];
+    for(uint32_t i = begin; i < end; ++i) {
+      if(!topology.contourClosed[c] && i != begin && i + 1 != end)
+        continue;
+      candidates.push_back({ path.vertices[vertices[i]], static_cast<uint32_t>(candidateVertex.size()) });
+      candidateVertex.push_back(vertices[i]);
+    }
+  }
+  std::vector<uint32_t> candidateContour(candidateVertex.size());
+  {
+    size_t next = 0;
+    for(uint32_t c = 0; c < contourCount; ++c) {
+      const size_t count = topology.contourClosed[c] ?
+        vertexOffsets[c + 1] - vertexOffsets[c] :
+        (vertexOffsets[c + 1] - vertexOffsets[c] > 1 ? 2 : 1);
+      std::fill(candidateContour.begin() + next, candidateContour.begin() + next + count, c);
+      next += count;
+    }
+  }
+
+  PointTree tree(std::move(candidates));
+
+  //Tree positions of each contour's candidates, to remove them once it is cut.
+  std::vector<uint32_t> positionOffsets(contourCount + 1, 0);
+  std::vector<uint32_t> positions(tree.Size());
+  for(size_t i = 0; i < tree.Size(); ++i)
+    ++positionOffsets[candidateContour[tree.At(i).id] + 1];
+  for(size_t c = 0; c < contourCount; ++c)
+    positionOffsets[c + 1] += positionOffsets[c];
+  {
+    std::vector<uint32_t> fill(positionOffsets.begin(), positionOffsets.end() - 1);
+    for(size_t i = 0; i < tree.Size(); ++i)
+      positions[fill[candidateContour[tree.At(i).id]]++] = static_cast<uint32_t>(i);
+  }
+
+  //first/last: where each contour is entered and left when cut forwards.
+  std::vector<Vector2> first(contourCount);
+  std::vector<Vector2> last(contourCount);
+  std::vector<uint32_t> order;
+  order.reserve(contourCount);
+
+  Vector2 head = options.start;
+  while(order.size() < contourCount) {
+    const size_t nearest = tree.Nearest(head);
+    const uint32_t candidate = tree.At(nearest).id;
+    const uint32_t c = candidateContour[candidate];
+    const uint32_t vertex = candidateVertex[candidate];
+
+    if(topology.contourClosed[c]) {
+      plan.entry[c] = vertex;
+      first[c] = last[c] = path.vertices[vertex];
+    }
+    else {
+      plan.entry[c] = vertices[vertexOffsets[c]];
+      first[c] = path.vertices[vertices[vertexOffsets[c]]];
+      last[c] = path.vertices[vertices[vertexOffsets[c + 1] - 1]];
+      plan.reversed[c] = vertex != plan.entry[c];
+    }
+
+    for(uint32_t i = positionOffsets[c]; i < positionOffsets[c + 1]; ++i)
+      tree.Remove(positions[i]);
+
+    if(!order.empty())
+      plan.nearestNeighbourDistance += Distance(head, plan.reversed[c] ? last[c] : first[c]);
+    order.push_back(c);
+    head = plan.reversed[c] ? first[c] : last[c];
+  }
+
+  Tour tour(first, last, std::move(order), plan.reversed);
+
+  //Neighbour lists over where each contour is currently left.
+  std::vector<PointTree::Point> exits(contourCount);
+  for(uint32_t c = 0; c < contourCount; ++c)
+    exits[c] = { plan.reversed[c] ? first[c] : last[c], c };
+  PointTree exitTree(std::move(exits));
+  std::vector<uint32_t> neighbours(contourCount * NEIGHBOURS, NONE);
+  std::vector<std::pair<double, size_t>> found;
+  for(uint32_t c = 0; c < contourCount; ++c) {
+    exitTree.KNearest(plan.reversed[c] ? first[c] : last[c], NEIGHBOURS + 1, found);
+    size_t k = 0;
+    for(const auto& hit : found) {
+      const uint32_t other = exitTree.At(hit.second).id;
+      if(other != c && k < NEIGHBOURS)
+        neighbours[c * NEIGHBOURS + k++] = other;
+    }
+  }
+
+  //Contours are worked from a queue. One whose moves all fail leaves it
+  //until a move elsewhere changes a leg next to it, so settled parts of the
+  //tour aren't searched again.
+  std::deque<uint32_t> queue(tour.Order().begin(), tour.Order().end());
+  std::vector<uint8_t> queued(contourCount, 1);
+  const auto requeue = [&] {
+    for(const uint32_t touched : tour.Touched()) {
+      if(!queued[touched]) {
+        queued[touched] = 1;
+        queue.push_back(touched);
+      }
+    }
+  };
+
+  const bool timed = std::isfinite(options.timeBudget);
+  const auto budget = std::chrono::duration<double>(timed ? options.timeBudget : 0);
+  const size_t maxVisits = options.visitsPerContour * contourCount;
+  size_t visits = 0;
+  while(contourCount > 2 && !queue.empty() && visits < maxVisits) {
+    if(++visits % 256 == 0 && timed && Clock::now() - started > budget)
+      break;
+
+    const uint32_t c = queue.front();
+    queue.pop_front();
+    queued[c] = 0;
+
+    bool moved = false;
+    for(size_t k = 0; k < NEIGHBOURS && !moved; ++k) {
+      const uint32_t other = neighbours[c * NEIGHBOURS + k];
+      if(other == NONE)
+        break;
+
+      //2-opt joining c's exit to other's exit.
+      const size_t a = tour.Slot(c);
+      const size_t b = tour.Slot(other);
+      moved = tour.TryTwoOpt(static_cast<long>(std::min(a, b)), std::max(a, b));
+
+      //Or-opt: follow other with the run starting at c.
+      for(size_t length = 1; length <= 3 && !moved; ++length)
+        moved = tour.TryOrOpt(tour.Slot(c), length, tour.Slot(other));
+    }
+
+    //Reversing the start of the tour has no partner to find it by.
+    if(!moved)
+      moved = tour.TryTwoOpt(-1, tour.Slot(c));
+
+    if(moved)
+      requeue();
+  }
+
+  //Closed contours can be entered anywhere; pick the vertex that best joins
+  //the legs on either side.
+  plan.order = tour.Order();
+  for(size_t slot = 0; slot < plan.order.size(); ++slot) {
+    const uint32_t c = plan.order[slot];
+    if(!topology.contourClosed[c])
+      continue;
+
+    const bool hasPrevious = slot > 0;
+    const bool hasNext = slot + 1 < plan.order.size();
+    const Vector2 previous = hasPrevious ? tour.Out(slot - 1) : Vector2{ 0, 0 };
+    const Vector2 next = hasNext ? tour.In(slot + 1) : Vector2{ 0, 0 };
+    if(!hasPrevious && !hasNext)
+      continue;
+
+    double bestCost = std::numeric_limits<double>::infinity();
+    for(uint32_t i = vertexOffsets[c]; i < vertexOffsets[c + 1]; ++i) {
+      const Vector2& p = path.vertices[vertices[i]];
+      const double cost = (hasPrevious ? Distance(previous, p) : 0) + (hasNext ? Distance(p, next) : 0);
+      if(cost < bestCost) {
+        bestCost = cost;
+        plan.entry[c] = vertices[i];
+        first[c] = last[c] = p;
+      }
+    }
+  }
+
+  for(uint32_t c = 0; c < contourCount; ++c) {
+    if(topology.contourClosed[c])
+      plan.reversed[c] = 0;
+    else
+      plan.entry[c] = plan.reversed[c] ? vertices[vertexOffsets[c + 1] - 1] : vertices[vertexOffsets[c]];
+  }
+
+  plan.rapidDistance = TourDistance(tour);
+  return plan;
+}
+
+double PlanRapidDistance(const IndexedPath& path) {
+  const auto topology = AnalyzeTopology(path);
+  if(topology.ContourCount() < 2)
+    return 0;
+  return PlanRapidMoves(path, topology, DefaultRapidOptions()).rapidDistance;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "IndexedPath.h"
+#include "PathTopology.h"
+#include "Vector2.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//Orders a path's contours and picks where to enter each so the head spends
+//as little time as possible on rapid, non-cutting moves between them.
+//
+//A closed contour can be entered at any of its vertices and is left at the
+//same one; an open chain is cut end to end in either direction. The first
+//tour is built nearest neighbour first with a k-d tree over every possible
+//entry point. It is then improved with 2-opt and Or-opt moves tried against
+//each contour's nearest neighbours, until no move helps or the budget runs
+//out, and closed contours finally get the entry vertex that best joins the
+//legs on either side.
+
+struct RapidOptions {
+  Vector2 start; //Where the head starts; the first contour is the one nearest it
+
+  //Improvement stops after this many contour visits per contour. The plan
+  //depends only on the path and the options, never on how busy the machine is.
+  size_t visitsPerContour;
+
+  //Seconds allowed for improvement after nearest neighbour, on top of the
+  //visit budget. Infinite unless set; a finite budget makes the plan depend
+  //on timing, so quotes leave it off.
+  double timeBudget;
+};
+
+struct RapidPlan {
+  std::vector<uint32_t> order; //Contours in cutting order
+  std::vector<uint32_t> entry; //Entry vertex of each contour, by contour
+  std::vector<uint8_t> reversed; //Open chains cut from their last vertex back, by contour
+
+  //Total rapid distance between consecutive contours. The move from start
+  //to the first contour is not included; it depends on where the previous
+  //job left the head.
+  double rapidDistance;
+  double nearestNeighbourDistance; //The same before improvement
+};
+
+//Starts at the origin with a fixed visit budget and no time budget, so the
+//same path always gets the same plan. 10^5 contours settle in well under a
+//second.
+RapidOptions DefaultRapidOptions();
+
+RapidPlan PlanRapidMoves(const IndexedPath& path, const PathTopology& topology, const RapidOptions& options);
+
+//Rapid distance of the plan for path under the default options, which is
+//what quotes charge for.
+double PlanRapidDistance(const IndexedPath& path);
@@ -0,0 +1,180 @@
+#include "Server.h"
+#include "MachineInfo.h"
+#include "Quote.h"
+#include "QuoteCache.h"
+#include "ThreadPool.h"
+#include "picojson.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+const char* const STATS_REQUEST = "!stats";
+
+//Longest request line a socket client may send. Inline documents past this
+//should be passed by filename instead.
+const size_t MAX_REQUEST_BYTES = 256 * 1024 * 1024;
+
+//Scratch storage reused by every request a thread serves.
+QuoteBuffers& ThreadBuffers() {
+  thread_local QuoteBuffers buffers;
+  return buffers;
+}
+
+//Returns the response line for a request, or an empty string for a blank line.
+std::string HandleRequest(const MachineInfo& tooling, const ServeOptions& options, std::string request) {
+  while(!request.empty() && isspace(static_cast<unsigned char>(request.back())))
+    request.pop_back();
+
+  const auto start = request.find_first_not_of(" \t");
+  if(start == std::string::npos)
+    return std::string();
+
+  if(request.compare(start, std::string::npos, STATS_REQUEST) == 0) {
+    if(!options.cache)
+      return "{\"error\":\"quote cache disabled\"}";
+    return QuoteCacheStatsJson(options.cache->GetStats());
+  }
+
+  try {
+    auto& buffers = ThreadBuffers();
+    const bool isDocument = request[start] == '{';
+    if(options.catalog) {
+      thread_local std::vector<Quote> quotes;
+      if(isDocument)
+        QuoteDocument(*options.catalog, request.data() + start, request.size() - start, buffers, options.cache, quotes);
+      else
+        QuoteFile(*options.catalog, request.substr(start), buffers, options.cache, quotes);
+      return "{\"quotes\":" + QuoteTableJson(*options.catalog, quotes) + "}";
+    }
+
+    const auto quote = isDocument ?
+      QuoteDocument(tooling, request.data() + start, request.size() - start, buffers, options.cache) :
+      QuoteFile(tooling, request.substr(start), buffers, options.cache);
+    return "{" + QuoteJsonFields(quote) + "}";
+  }
+  catch(const std::exception& e) {
+    return "{\"error\":" + picojson::value(e.what()).serialize() + "}";
+  }
+}
+
+bool WriteAll(int fd, const std::string& data) {
+  size_t written = 0;
+  while(written < data.size()) {
+    const auto count = write(fd, data.data() + written, data.size() - written);
+    if(count < 0 && errno == EINTR)
+      continue;
+    if(count <= 0)
+      return false;
+    written += static_cast<size_t>(count);
+  }
+  return true;
+}
+
+void ServeConnection(const MachineInfo& tooling, const ServeOptions& options, int fd) {
+  std::string pending;
+  char chunk[64 * 1024];
+
+  for(;;) {
+    const auto count = read(fd, chunk, sizeof(chunk));
+    if(count < 0 && errno == EINTR)
+      continue;
+
+    //A final request without a trailing newline is still answered.
+    if(count <= 0) {
+      const auto response = HandleRequest(tooling, options, pending);
+      if(!response.empty())
+        WriteAll(fd, response + "\n");
+      return;
+    }
+
+    //Only the new bytes can hold a newline; what was already pending has
+    //been searched.
+    const size_t scanFrom = pending.size();
+    pending.append(chunk, static_cast<size_t>(count));
+
+    size_t lineStart = 0;
+    for(size_t newline = scanFrom; (newline = pending.find('\n', newline)) != std::string::npos; ++newline) {
+      const auto response = HandleRequest(tooling, options, pending.substr(lineStart, newline - lineStart));
+      if(!response.empty() && !WriteAll(fd, response + "\n"))
+        return;
+      lineStart = newline + 1;
+    }
+    if(lineStart > 0)
+      pending.erase(0, lineStart);
+
+    //A client that never ends its line must not grow the server without bound.
+    if(pending.size() > MAX_REQUEST_BYTES) {
+      WriteAll(fd, "{\"error\":\"request line too long\"}\n");
+      return;
+    }
+  }
+}
+
+int ServeStdin(const MachineInfo& tooling, const ServeOptions& options) {
+  std::string request;
+  while(std::getline(std::cin, request)) {
+    const auto response = HandleRequest(tooling, options, request);
+    if(!response.empty())
+      std::cout << response << std::endl;
+  }
+  return 0;
+}
+
+int ServeSocket(const MachineInfo& tooling, const ServeOptions& options) {
+  sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if(options.socketPath.size() >= sizeof(address.sun_path))
+    throw std::runtime_error("Socket path too long: " + options.socketPath);
+  strncpy(address.sun_path, options.socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+  const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  if(listener < 0)
+    throw std::runtime_error(std::string("Error creating socket: ") + strerror(errno));
+
+  //A stale socket file from a previous run would make bind fail.
+  unlink(options.socketPath.c_str());
+  if(bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+     listen(listener, SOMAXCONN) != 0) {
+    const int err = errno;
+    close(listener);
+    throw std::runtime_error("Error listening on " + options.socketPath + ": " + strerror(err));
+  }
+
+  //Clients hanging up mid-response must not take the server down.
+  signal(SIGPIPE, SIG_IGN);
+
+  ThreadPool pool(options.threads);
+  for(;;) {
+    const int client = accept(listener, nullptr, nullptr);
+    if(client < 0) {
+      if(errno == EINTR || errno == ECONNABORTED)
+        continue;
+      const int err = errno;
+      close(listener);
+      throw std::runtime_error(std::string("Error accepting connection: ") + strerror(err));
+    }
+
+    pool.Submit([&tooling, &options, client] {
+      ServeConnection(tooling, options, client);
+      close(client);
+    });
+  }
+}
+
+}
+
+int RunServer(const MachineInfo& tooling, const ServeOptions& options) {
+  if(options.socketPath.empty())
+    return ServeStdin(tooling, options);
+  return ServeSocket(tooling, options);
+}
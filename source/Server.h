@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+
+struct MachineInfo;
+struct ToolingCatalog;
+class QuoteCache;
+
+struct ServeOptions {
+  std::string socketPath; //Empty to serve stdin/stdout instead of a Unix domain socket
+  unsigned threads;
+  QuoteCache* cache; //Optional
+  const ToolingCatalog* catalog; //Optional; quotes every entry instead of tooling
+};
+
+//Stays resident answering quote requests, one per line. A request is either
+//a whole path document written on a single line, or the filename of a json
+//or binary path. Each gets exactly one json line back, either
+//{"cut_time":..,"cost":..} or {"error":".."}; with a catalog the quote is
+//{"quotes":[{"machine":..,"cut_time":..,"cost":..},..]}. The request "!stats" returns
+//the cache counters instead.
+//
+//On stdin requests are answered in order until end of input. On a socket
+//each connection is owned by a pool worker for its lifetime, so up to
+//options.threads clients are served concurrently. Loader and ToolPath
+//buffers are kept per worker and reused between requests. A connection
+//whose request line grows past 256 MiB gets an error and is closed.
+int RunServer(const MachineInfo& tooling, const ServeOptions& options);
@@ -0,0 +1,107 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace {
+  //Identifies the pool and worker the current thread belongs to, so nested
+  //submissions can go to the local deque.
+  thread_local const ThreadPool* t_pool = nullptr;
+  thread_local size_t t_worker = 0;
+}
+
+ThreadPool::ThreadPool(unsigned threadCount) {
+  threadCount = std::max(1u, threadCount);
+  for(unsigned i = 0; i < threadCount; ++i)
+    m_workers.emplace_back(new Worker);
+
+  for(unsigned i = 0; i < threadCount; ++i)
+    m_threads.emplace_back(&ThreadPool::Run, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+  Wait();
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_wake.notify_all();
+
+  for(auto& thread : m_threads)
+    thread.join();
+}
+
+void ThreadPool::Submit(std::function<void()> task) {
+  {
+    //The counters are bumped in the same critical section as the push, so a
+    //thief can never pick the task up before it has been counted.
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const size_t target = (t_pool == this) ? t_worker : (m_nextWorker++ % m_workers.size());
+
+    auto& worker = *m_workers[target];
+    {
+      std::lock_guard<std::mutex> workerLock(worker.mutex);
+      worker.tasks.push_back(std::move(task));
+    }
+
+    ++m_pending;
+    ++m_queued;
+  }
+  m_wake.notify_one();
+}
+
+void ThreadPool::Wait() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_idle.wait(lock, [this] { return m_pending == 0; });
+}
+
+bool ThreadPool::TryPop(size_t self, std::function<void()>& task) {
+  {
+    auto& own = *m_workers[self];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if(!own.tasks.empty()) {
+      task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+      return true;
+    }
+  }
+
+  for(size_t i = 1; i < m_workers.size(); ++i) {
+    auto& victim = *m_workers[(self + i) % m_workers.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if(!victim.tasks.empty()) {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void ThreadPool::Run(size_t self) {
+  t_pool = this;
+  t_worker = self;
+
+  std::function<void()> task;
+  for(;;) {
+    if(TryPop(self, task)) {
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        --m_queued;
+      }
+
+      task();
+      task = nullptr;
+
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if(--m_pending == 0)
+        m_idle.notify_all();
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_wake.wait(lock, [this] { return m_stop || m_queued > 0; });
+    if(m_stop && m_queued == 0)
+      return;
+  }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//Fixed size work-stealing thread pool.
+//Every worker owns a deque: it pops its own work from the back and, when
+//that runs dry, steals from the front of the other workers' deques. Tasks
+//submitted from a worker thread stay on that worker's deque; tasks
+//submitted from outside are dealt out round-robin.
+class ThreadPool {
+public:
+  explicit ThreadPool(unsigned threadCount);
+  ~ThreadPool();
+
+  void Submit(std::function<void()> task);
+
+  //Blocks until every submitted task has finished.
+  void Wait();
+
+  size_t ThreadCount() const { return m_threads.size(); }
+
+private:
+  struct Worker {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  bool TryPop(size_t self, std::function<void()>& task);
+  void Run(size_t self);
+
+  std::vector<std::unique_ptr<Worker>> m_workers;
+  std::vector<std::thread> m_threads;
+
+  //Guards the counters below; only touched once per task, not per steal attempt.
+  std::mutex m_mutex;
+  std::condition_variable m_wake;
+  std::condition_variable m_idle;
+  size_t m_queued = 0; //submitted but not yet picked up
+  size_t m_pending = 0; //submitted but not yet finished
+  size_t m_nextWorker = 0;
+  bool m_stop = false;
+};
@@ -1,7 +1,11 @@
 #include "ToolPath.h"
 #include "JsonSerialization.h"
+#include "GeometryKernels.h"
+#include "VertexIdTable.h"
 
-#include <unordered_map>
+#include <algorithm>
+#include <atomic>
+#include <limits>
 
 //Helper function for enforcing error checking when parsing json
 template<typename T = picojson::value>
@@ -25,20 +29,196 @@ const picojson::value& GetRequired(const picojson::value& v, const std::string&
   return v.get(name);
 }
 
+void ToolPath::LineEdges::Add(const Vector2& v0, const Vector2& v1) {
+  x0.push_back(v0.x); y0.push_back(v0.y);
+  x1.push_back(v1.x); y1.push_back(v1.y);
+}
+
+namespace {
+
+std::atomic<bool> g_fastArcMath(false);
+
+//Derived geometry of one arc, shared by ArcEdges::Add and ArcGeometry.
+struct ArcShape {
+  double radius;
+  double startAngle;
+  double sweep;
+  double effectiveLength;
+  Vector2 minPoint, maxPoint;
+};
+
+ArcShape ComputeArcShape(const Vector2& v0, const Vector2& v1, const Vector2& center) {
+  const auto r = Distance(center,v0);
+  const auto arcLine0 = (v0 - center) / r;
+  const auto arcLine1 = (v1 - center) / r;
+
+  //The travel heuristic has always used the unsigned angle between the two
+  //endpoints rather than the counter-clockwise sweep; kept so quotes don't move.
+  //Clamped, as the dot product of two unit vectors can round just past +-1.
+  const double arcAngle = acos(std::max(-1.0, std::min(1.0, Dot(arcLine0, arcLine1))));
+  const double arcLength = arcAngle * r;
+
+  //Scale to account for linear stepper arc traversing behavior
+  const auto arcEffectiveLength = arcLength * (1/exp(-1/r));
+
+  const auto a0 = atan2(arcLine0.y, arcLine0.x);
+  auto a1 = atan2(arcLine1.y, arcLine1.x);
+
+  //ensure a1 > a0 so that the clamping operation works correctly
+  if( a1 <= a0)
+    a1 += 2*M_PI;
+
+  //we only care about the 4 maximal points on the circle, or in the case of the arc,
+  //the ones that fit within the arc boundaries.
+  Vector2 minPoint = { std::numeric_limits<double>::max(), std::numeric_limits<double>::max() };
+  Vector2 maxPoint = { std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest() };
+  for(int dir = 0; dir < 4; ++dir) {
+    double theta = M_PI_2 * dir;
+    theta = std::min( a1, std::max(a0, theta) ); //clamp between a0 and a1
+
+    const Vector2 angleVector = { cos(theta)*r, sin(theta)*r };
+    const Vector2 arcPoint = center + angleVector;
+
+    PiecewiseMin(minPoint, arcPoint);
+    PiecewiseMax(maxPoint, arcPoint);
+  }
+
+  return { r, a0, a1 - a0, arcEffectiveLength, minPoint, maxPoint };
+}
+
+}
+
+void SetFastArcMath(bool enabled) {
+  g_fastArcMath = enabled;
+}
+
+bool FastArcMath() {
+  return g_fastArcMath.load(std::memory_order_relaxed);
+}
+
+void ToolPath::ArcEdges::Add(const Vector2& v0, const Vector2& v1, const Vector2& center) {
+  AddEnds(v0, v1, center);
+  Shape(Size() - 1);
+}
+
+void ToolPath::ArcEdges::AddEnds(const Vector2& v0, const Vector2& v1, const Vector2& center) {
+  x0.push_back(v0.x); y0.push_back(v0.y);
+  x1.push_back(v1.x); y1.push_back(v1.y);
+  cx.push_back(center.x); cy.push_back(center.y);
+}
+
+void ToolPath::ArcEdges::Shape(size_t begin) {
+  const size_t end = Size();
+  for(auto* values : { &radius, &startAngle, &sweep, &effectiveLength, &minX, &minY, &maxX, &maxY })
+    values->resize(end);
+
+  if(FastArcMath()) {
+    const ArcArrays arrays = {
+      x0.data() + begin, y0.data() + begin, x1.data() + begin, y1.data() + begin,
+      cx.data() + begin, cy.data() + begin,
+      radius.data() + begin, startAngle.data() + begin, sweep.data() + begin,
+      effectiveLength.data() + begin,
+      minX.data() + begin, minY.data() + begin, maxX.data() + begin, maxY.data() + begin
+    };
+    ShapeArcsFast(arrays, end - begin);
+    return;
+  }
+
+  for(size_t i = begin; i < end; ++i) {
+    const auto shape = ComputeArcShape({ x0[i], y0[i] }, { x1[i], y1[i] }, { cx[i], cy[i] });
+    radius[i] = shape.radius;
+    startAngle[i] = shape.startAngle;
+    sweep[i] = shape.sweep;
+    effectiveLength[i] = shape.effectiveLength;
+    minX[i] = shape.minPoint.x; minY[i] = shape.minPoint.y;
+    maxX[i] = shape.maxPoint.x; maxY[i] = shape.maxPoint.y;
+  }
+}
+
+EdgeGeometry LineGeometry(const Vector2& v0, const Vector2& v1) {
+  EdgeGeometry geometry = { Distance(v0, v1), v0, v0 };
+  PiecewiseMin(geometry.minPoint, v1);
+  PiecewiseMax(geometry.maxPoint, v1);
+  return geometry;
+}
+
+EdgeGeometry ArcGeometry(const Vector2& v0, const Vector2& v1, const Vector2& center) {
+  if(FastArcMath()) {
+    double radius, startAngle, sweep;
+    EdgeGeometry geometry;
+    const ArcArrays arrays = {
+      &v0.x, &v0.y, &v1.x, &v1.y, &center.x, &center.y,
+      &radius, &startAngle, &sweep, &geometry.travel,
+      &geometry.minPoint.x, &geometry.minPoint.y, &geometry.maxPoint.x, &geometry.maxPoint.y
+    };
+    ShapeArcsFast(arrays, 1);
+    return geometry;
+  }
+
+  const auto shape = ComputeArcShape(v0, v1, center);
+  return { shape.effectiveLength, shape.minPoint, shape.maxPoint };
+}
+
+void ToolPath::AddLineSegment(const Vector2& v0, const Vector2& v1) {
+  m_lines.Add(v0, v1);
+}
+
+void ToolPath::AddCircularArc(const Vector2& v0, const Vector2& v1, const Vector2& center) {
+  m_arcs.Add(v0, v1, center);
+}
+
+void ToolPath::AddCircularArcs(const Vector2* vertices, const IndexedPath::Arc* arcs, size_t count) {
+  const size_t begin = m_arcs.Size();
+  for(size_t i = 0; i < count; ++i)
+    m_arcs.AddEnds(vertices[arcs[i].v0], vertices[arcs[i].v1], arcs[i].center);
+  m_arcs.Shape(begin);
+}
+
+void ToolPath::Reserve(size_t lineCount, size_t arcCount) {
+  for(auto* coords : { &m_lines.x0, &m_lines.y0, &m_lines.x1, &m_lines.y1 })
+    coords->reserve(lineCount);
+
+  for(auto* values : { &m_arcs.x0, &m_arcs.y0, &m_arcs.x1, &m_arcs.y1, &m_arcs.cx, &m_arcs.cy,
+                        &m_arcs.radius, &m_arcs.startAngle, &m_arcs.sweep, &m_arcs.effectiveLength,
+                        &m_arcs.minX, &m_arcs.minY, &m_arcs.maxX, &m_arcs.maxY })
+    values->reserve(arcCount);
+}
+
+void ToolPath::Clear() {
+  for(auto* values : { &m_lines.x0, &m_lines.y0, &m_lines.x1, &m_lines.y1 })
+    values->clear();
+
+  for(auto* values : { &m_arcs.x0, &m_arcs.y0, &m_arcs.x1, &m_arcs.y1, &m_arcs.cx, &m_arcs.cy,
+                        &m_arcs.radius, &m_arcs.startAngle, &m_arcs.sweep, &m_arcs.effectiveLength,
+                        &m_arcs.minX, &m_arcs.minY, &m_arcs.maxX, &m_arcs.maxY })
+    values->clear();
+}
+
 ToolPath::ToolPath(const picojson::value &v) {
   const auto& vertices = GetRequired<picojson::object>(v,"Vertices");
 
+  //Vertex positions are only needed until the edges have copied them.
+  std::vector<Vector2> positions;
+  positions.reserve(vertices.size());
+
   //Temporary cache of old vertexIds to new Vertex indexes.
-  std::unordered_map<std::string,size_t> vertexIndexes;
+  VertexIdTable vertexIndexes;
   for(const auto& vertex : vertices) {
     const auto& vertexID = vertex.first;
-    vertexIndexes[vertexID] = m_vertices.size();
+    vertexIndexes.Define(vertexIndexes.KeyFromString(vertexID), static_cast<uint32_t>(positions.size()));
 
-    m_vertices.push_back(
+    positions.push_back(
       ParseVector(GetRequired(vertex.second,"Position"))
     );
   }
 
+  vertexIndexes.Finalize();
+
+  const auto edgeVertexKey = [&](const picojson::value& id) {
+    return id.is<double>() ? vertexIndexes.KeyFromNumber(id.get<double>())
+                           : vertexIndexes.KeyFromString(id.to_str());
+  };
+
   const auto& edges = GetRequired<picojson::object>(v, "Edges");
 
   for(const auto& edge : edges) {
@@ -47,12 +227,15 @@ ToolPath::ToolPath(const picojson::value &v) {
 
     const auto& edgeVertices = edge.second.get("Vertices").get<picojson::array>();
 
-    Vector2* v0 = &m_vertices[ vertexIndexes[edgeVertices[0].to_str()] ];
-    Vector2* v1 = &m_vertices[ vertexIndexes[edgeVertices[1].to_str()] ];
+    if(edgeVertices.size() < 2)
+      throw std::runtime_error("Error parsing json: Edge has fewer than 2 Vertices");
+
+    const Vector2* v0 = &positions[ vertexIndexes.Resolve(edgeVertexKey(edgeVertices[0])) ];
+    const Vector2* v1 = &positions[ vertexIndexes.Resolve(edgeVertexKey(edgeVertices[1])) ];
 
     const auto& type = GetRequired<std::string>(edge.second,"Type");
     if(type == "LineSegment"){
-      m_linearEdges.push_back(LinearEdge(v0,v1));
+      AddLineSegment(*v0,*v1);
     }
     else if( type == "CircularArc") {
       //Ensure that v0 is the first vertex on the arc, moving counter-clockwise.
@@ -63,83 +246,93 @@ ToolPath::ToolPath(const picojson::value &v) {
       if(!edge.second.contains("Center"))
         throw std::runtime_error("Error parsing json: Arc has no center");
 
-      m_arcEdges.push_back(ArcEdge(v0,v1,ParseVector( GetRequired(edge.second,"Center") )));
+      AddCircularArc(*v0,*v1,ParseVector( GetRequired(edge.second,"Center") ));
     }
     else
       throw std::runtime_error("Error parsing json: Unkown edge type: " + type);
   }
 }
 
-//Assumes the edges form a connected shape, we can garuntee that
-//the total tool travel time is the sum of the travel time of each edge.
-double ToolPath::ComputeTravelHeuristic() const {
-  double sumDistance = 0;
+Vector2 PathMetrics::Bounds() const {
+  if(lines.count + arcs.count == 0)
+    return { 0, 0 };
+  return maxPoint - minPoint;
+}
 
-  for( const auto& edge : m_linearEdges) {
-    const auto dist = Distance(*edge.v0,*edge.v1);
-    sumDistance += dist;
-  }
+namespace {
 
-  for(const auto& arc : m_arcEdges) {
-    const auto &v0 = *arc.v0;
-    const auto &v1 = *arc.v1;
+PathMetrics::EdgeStats MergeStats(const PathMetrics::EdgeStats& a, const PathMetrics::EdgeStats& b) {
+  return { a.count + b.count, a.travel + b.travel, std::min(a.shortest, b.shortest), std::max(a.longest, b.longest) };
+}
 
-    const auto radius = Distance(arc.center,v0);
-    const auto arcLine0 = (v0 - arc.center) / radius;
-    const auto arcLine1 = (v1 - arc.center) / radius;
-    const double arcAngle = acos(Dot(arcLine0, arcLine1));
-    const double arcLength = arcAngle * radius;
+}
 
-    //Scale to account for linear stepper arc traversing behavior
-    const auto arcEffectiveLength = arcLength * (1/exp(-1/radius));
-    sumDistance += arcEffectiveLength;
-  }
+PathMetrics MergeMetrics(const PathMetrics& a, const PathMetrics& b) {
+  PathMetrics merged;
+  merged.travel = a.travel + b.travel;
+  merged.minPoint = a.minPoint;
+  merged.maxPoint = a.maxPoint;
+  PiecewiseMin(merged.minPoint, b.minPoint);
+  PiecewiseMax(merged.maxPoint, b.maxPoint);
+  merged.lines = MergeStats(a.lines, b.lines);
+  merged.arcs = MergeStats(a.arcs, b.arcs);
+  return merged;
+}
 
-  return sumDistance;
-};
+//Assumes the edges form a connected shape, we can garuntee that
+//the total tool travel time is the sum of the travel time of each edge.
+double ToolPath::ComputeTravelHeuristic() const {
+  return Evaluate().travel;
+}
 
 Vector2 ToolPath::ComputeBounds() const {
-  Vector2 minPoint = { std::numeric_limits<double>::max(), std::numeric_limits<double>::max() };
-  Vector2 maxPoint = { std::numeric_limits<double>::min(), std::numeric_limits<double>::min() };
+  return Evaluate().Bounds();
+}
 
-  for( const auto& edge : m_linearEdges) {
-    PiecewiseMin(minPoint, *edge.v0);
-    PiecewiseMin(minPoint, *edge.v1);
+PathMetrics ToolPath::Evaluate() const {
+  return Evaluate({ 0, m_lines.Size(), 0, m_arcs.Size() });
+}
 
-    PiecewiseMax(maxPoint, *edge.v0);
-    PiecewiseMax(maxPoint, *edge.v1);
+PathMetrics ToolPath::Evaluate(const EdgeRange& range) const {
+  const size_t lineCount = range.lineEnd - range.lineBegin;
+  SegmentSummary lines = EmptySegmentSummary();
+  SummarizeSegments(m_lines.x0.data() + range.lineBegin, m_lines.y0.data() + range.lineBegin,
+                    m_lines.x1.data() + range.lineBegin, m_lines.y1.data() + range.lineBegin,
+                    lineCount, lines);
+
+  PathMetrics metrics;
+  metrics.lines = { lineCount, lines.lengthSum, lines.minLength, lines.maxLength };
+  metrics.minPoint = { lines.minX, lines.minY };
+  metrics.maxPoint = { lines.maxX, lines.maxY };
+
+  //Arc travel and extents were precomputed in ArcEdges::Shape, so this is a
+  //plain streaming reduction over six arrays.
+  auto& arcs = metrics.arcs;
+  arcs = { range.arcEnd - range.arcBegin, 0, std::numeric_limits<double>::infinity(), 0 };
+  for(size_t i = range.arcBegin; i < range.arcEnd; ++i) {
+    const double length = m_arcs.effectiveLength[i];
+    arcs.travel += length;
+    arcs.shortest = std::min(arcs.shortest, length);
+    arcs.longest = std::max(arcs.longest, length);
+
+    metrics.minPoint.x = std::min(metrics.minPoint.x, m_arcs.minX[i]);
+    metrics.minPoint.y = std::min(metrics.minPoint.y, m_arcs.minY[i]);
+    metrics.maxPoint.x = std::max(metrics.maxPoint.x, m_arcs.maxX[i]);
+    metrics.maxPoint.y = std::max(metrics.maxPoint.y, m_arcs.maxY[i]);
   }
 
-  for( const auto& edge : m_arcEdges) {
-    const auto &v0 = *edge.v0;
-    const auto &v1 = *edge.v1;
-    const auto &center = edge.center;
-
-    const auto radius = Distance(center,v0);
-    const auto arcLine0 = (v0 - center) / radius;
-    const auto arcLine1 = (v1 - center) / radius;
-
-    //we only care about the 4 maximal points on the circle, or in the case of the arc,
-    //the ones that fit within the arc boundaries.
-    const auto a0 = atan2(arcLine0.y, arcLine0.x);
-    auto a1 = atan2(arcLine1.y, arcLine1.x);
-
-    //ensure a1 > a0 so that the clamping operation works correctly
-    if( a1 <= a0)
-      a1 += 2*M_PI;
-
-    //For each of the 4 cardinal directions...
-    for(int i = 0; i < 4; ++i) {
-      double theta = M_PI_2 * i;
-      theta = std::min( a1, std::max(a0, theta) ); //clamp between a0 and a1
+  metrics.travel = metrics.lines.travel + arcs.travel;
+  return metrics;
+}
 
-      const Vector2 angleVector = { cos(theta)*radius, sin(theta)*radius };
-      const Vector2 arcPoint = center + angleVector;
+std::vector<ToolPath::EdgeRange> ToolPath::Partition(size_t chunkCount) const {
+  const size_t lineCount = m_lines.Size(), arcCount = m_arcs.Size();
+  chunkCount = std::max<size_t>(1, std::min(chunkCount, std::max(lineCount, arcCount)));
 
-      PiecewiseMin(minPoint, arcPoint);
-      PiecewiseMax(maxPoint, arcPoint);
-    }
+  std::vector<EdgeRange> ranges;
+  for(size_t i = 0; i < chunkCount; ++i) {
+    ranges.push_back({ lineCount * i / chunkCount, lineCount * (i + 1) / chunkCount,
+                       arcCount * i / chunkCount, arcCount * (i + 1) / chunkCount });
   }
-
-  return maxPoint - minPoint;
+  return ranges;
 }
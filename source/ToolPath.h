@@ -1,39 +1,121 @@
 #pragma once
 #include "picojson.h"
+#include "IndexedPath.h"
 #include "Vector2.h"
 #include <vector>
 
+//Everything the quoting code needs from a single traversal of the edges.
+struct PathMetrics {
+  struct EdgeStats {
+    size_t count;
+    double travel; //Summed contribution to the travel heuristic
+    double shortest, longest; //Per edge travel contribution
+  };
+
+  double travel; //See ToolPath::ComputeTravelHeuristic
+  Vector2 minPoint, maxPoint;
+  EdgeStats lines, arcs;
+
+  //Size of the axis aligned bounding box; zero for an empty path.
+  Vector2 Bounds() const;
+};
+
+//Combines the metrics of two disjoint sets of edges.
+PathMetrics MergeMetrics(const PathMetrics& a, const PathMetrics& b);
+
+//One edge's contribution to the travel heuristic and its extent, exactly
+//as ToolPath::Evaluate counts them. For arcs, v0 must be the first vertex
+//on the arc moving counter-clockwise.
+struct EdgeGeometry {
+  double travel;
+  Vector2 minPoint, maxPoint;
+};
+
+EdgeGeometry LineGeometry(const Vector2& v0, const Vector2& v1);
+EdgeGeometry ArcGeometry(const Vector2& v0, const Vector2& v1, const Vector2& center);
+
+//Selects the FastMath.h approximations of acos, atan2 and exp for arc setup
+//in every ToolPath and ArcGeometry call that follows (cadquote
+//--fast-math-geometry). Off by default; see GeometryKernels.h for the accuracy.
+void SetFastArcMath(bool enabled);
+bool FastArcMath();
 
 class ToolPath {
 public:
 
+  ToolPath() {}
   ToolPath(const picojson::value &value);
 
+  //Construction from source. For arcs, v0 must be the first vertex on the
+  //arc moving counter-clockwise.
+  void AddLineSegment(const Vector2& v0, const Vector2& v1);
+  void AddCircularArc(const Vector2& v0, const Vector2& v1, const Vector2& center);
+
+  //Adds count arcs whose endpoints index into vertices. The arcs are shaped
+  //as one batch, which lets the fast arc math run across them vectorized.
+  void AddCircularArcs(const Vector2* vertices, const IndexedPath::Arc* arcs, size_t count);
+  void Reserve(size_t lineCount, size_t arcCount);
+
+  //Removes every edge, keeping the allocated storage.
+  void Clear();
+
   //Returns roughly the distance in inches, but scaled slightly to
   //account for accelleration time between direction changes and
   //the slower speed of traversing arcs.
   double ComputeTravelHeuristic() const;
 
   Vector2 ComputeBounds() const;
+
+  //Half-open ranges of line and arc indices, for evaluating a path in chunks.
+  struct EdgeRange {
+    size_t lineBegin, lineEnd;
+    size_t arcBegin, arcEnd;
+  };
+
+  //Travel, bounds and per edge type statistics in one fused pass, instead
+  //of the separate traversals ComputeTravelHeuristic and ComputeBounds make.
+  PathMetrics Evaluate() const;
+  PathMetrics Evaluate(const EdgeRange& range) const;
+
+  //Splits the edges into at most chunkCount ranges of similar size. The
+  //ranges can be evaluated on separate threads and combined with MergeMetrics.
+  std::vector<EdgeRange> Partition(size_t chunkCount) const;
 private:
 
-  //We parse all vertices before the edges, so it is safe to store pointers
-  //into the vertex set directly.
-  struct LinearEdge {
-    LinearEdge(Vector2* a, Vector2* b ) : v0(a), v1(b) {}
-    const Vector2* v0;
-    const Vector2* v1;
+  //Edges are stored as structure-of-arrays with the vertex positions copied
+  //in, so the geometry kernels can stream through contiguous coordinates
+  //instead of chasing a pointer per endpoint.
+  struct LineEdges {
+    std::vector<double> x0, y0;
+    std::vector<double> x1, y1;
+
+    void Add(const Vector2& v0, const Vector2& v1);
+    size_t Size() const { return x0.size(); }
   };
 
-  struct ArcEdge {
-    ArcEdge(Vector2* a, Vector2* b, const Vector2& c) : v0(a), v1(b), center(c) {}
-    const Vector2* v0;
-    const Vector2* v1;
-    const Vector2 center;
+  //v0 is always the first vertex on the arc, moving counter-clockwise.
+  //The derived geometry is computed once in Shape, so travel and bounds
+  //queries never touch the trig functions.
+  struct ArcEdges {
+    std::vector<double> x0, y0;
+    std::vector<double> x1, y1;
+    std::vector<double> cx, cy;
+
+    std::vector<double> radius;
+    std::vector<double> startAngle; //atan2 of v0 around the center
+    std::vector<double> sweep; //counter-clockwise, in (0, 2pi]
+    std::vector<double> effectiveLength; //contribution to the travel heuristic
+    std::vector<double> minX, minY; //extent of the arc itself
+    std::vector<double> maxX, maxY;
+
+    void Add(const Vector2& v0, const Vector2& v1, const Vector2& center);
+    void AddEnds(const Vector2& v0, const Vector2& v1, const Vector2& center);
+    //Fills in the derived geometry of arcs [begin, Size()).
+    void Shape(size_t begin);
+    size_t Size() const { return x0.size(); }
   };
 
-  std::vector<Vector2> m_vertices; //rarely accessed directly.
-  std::vector<LinearEdge> m_linearEdges;
-  std::vector<ArcEdge> m_arcEdges;
+  LineEdges m_lines;
+  ArcEdges m_arcs;
 };
 
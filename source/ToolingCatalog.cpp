@@ -0,0 +1,83 @@
+#include "ToolingCatalog.h"
+#include "MappedFile.h"
+#include "picojson.h"
+
+#include <stdexcept>
+
+namespace {
+
+[[noreturn]] void CatalogError(const std::string& message) {
+  throw std::runtime_error("Error parsing tooling catalog: " + message);
+}
+
+double RequireNumber(const picojson::object& entry, size_t index, const char* field) {
+  const auto found = entry.find(field);
+  if(found == entry.end() || !found->second.is<double>())
+    CatalogError("entry " + std::to_string(index) + " needs a numeric " + field);
+  return found->second.get<double>();
+}
+
+}
+
+void ToolingCatalog::Add(const std::string& name, const MachineInfo& tooling) {
+  names.push_back(name);
+  padding.push_back(tooling.padding);
+  maxSpeed.push_back(tooling.max_speed);
+  costPerS.push_back(tooling.cost_per_s);
+  costPerSqIn.push_back(tooling.cost_per_sq_in);
+  rapidSpeed.push_back(tooling.rapid_speed);
+  acceleration.push_back(tooling.acceleration);
+  junctionDeviation.push_back(tooling.junction_deviation);
+}
+
+MachineInfo ToolingCatalog::Get(size_t index) const {
+  return { padding[index], maxSpeed[index], costPerS[index], costPerSqIn[index], rapidSpeed[index],
+           acceleration[index], junctionDeviation[index] };
+}
+
+ToolingCatalog LoadToolingCatalog(const std::string& filename) {
+  MappedFile file(filename);
+
+  picojson::value document;
+  std::string err;
+  picojson::parse(document, file.Data(), file.Data() + file.Size(), &err);
+  if(!err.empty())
+    CatalogError(err);
+  if(!document.is<picojson::array>())
+    CatalogError("expected an array of machines");
+
+  ToolingCatalog catalog;
+  const auto& entries = document.get<picojson::array>();
+  for(size_t i = 0; i < entries.size(); ++i) {
+    if(!entries[i].is<picojson::object>())
+      CatalogError("entry " + std::to_string(i) + " is not an object");
+    const auto& entry = entries[i].get<picojson::object>();
+
+    const auto name = entry.find("Name");
+    if(name == entry.end() || !name->second.is<std::string>())
+      CatalogError("entry " + std::to_string(i) + " needs a Name");
+
+    const double maxSpeed = RequireNumber(entry, i, "MaxSpeed");
+    const MachineInfo tooling = {
+      RequireNumber(entry, i, "Padding"),
+      maxSpeed,
+      RequireNumber(entry, i, "CostPerSecond"),
+      RequireNumber(entry, i, "CostPerSquareInch"),
+      entry.count("RapidSpeed") ? RequireNumber(entry, i, "RapidSpeed") : maxSpeed,
+      entry.count("Acceleration") ? RequireNumber(entry, i, "Acceleration") : 0,
+      entry.count("JunctionDeviation") ? RequireNumber(entry, i, "JunctionDeviation") : 0
+    };
+    if(!(tooling.max_speed > 0))
+      CatalogError("entry " + std::to_string(i) + " needs a positive MaxSpeed");
+    if(!(tooling.rapid_speed > 0))
+      CatalogError("entry " + std::to_string(i) + " needs a positive RapidSpeed");
+    if(!(tooling.acceleration >= 0 && tooling.junction_deviation >= 0))
+      CatalogError("entry " + std::to_string(i) + " needs a non-negative Acceleration and JunctionDeviation");
+
+    catalog.Add(name->second.get<std::string>(), tooling);
+  }
+
+  if(catalog.Size() == 0)
+    CatalogError("no machines listed");
+  return catalog;
+}
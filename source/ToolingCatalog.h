@@ -0,0 +1,34 @@
+#pragma once
+
+#include "MachineInfo.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+//A named set of machine/material combinations quoted together.
+//Stored as parallel arrays rather than MachineInfo structs so a whole
+//catalog can be costed in one vectorizable pass (see ComputeQuotes).
+struct ToolingCatalog {
+  std::vector<std::string> names;
+  std::vector<double> padding; //In inches
+  std::vector<double> maxSpeed; //In inches per second
+  std::vector<double> costPerS; //In dollars per second
+  std::vector<double> costPerSqIn; //In dollars per square inch
+  std::vector<double> rapidSpeed; //In inches per second
+  std::vector<double> acceleration; //In inches per second squared
+  std::vector<double> junctionDeviation; //In inches
+
+  size_t Size() const { return names.size(); }
+  void Add(const std::string& name, const MachineInfo& tooling);
+  MachineInfo Get(size_t index) const;
+};
+
+//Reads a catalog file: a json array of entries such as
+//  { "Name": "Laser cut aluminum", "Padding": 0.1, "MaxSpeed": 0.5,
+//    "CostPerSecond": 0.07, "CostPerSquareInch": 0.75, "RapidSpeed": 4 }
+//RapidSpeed is optional and defaults to MaxSpeed. Acceleration and
+//JunctionDeviation are optional too; an entry with an Acceleration is timed
+//with the kinematic model in MotionPlanner.h.
+//Throws a runtime_error naming the entry and field for anything malformed.
+ToolingCatalog LoadToolingCatalog(const std::string& filename);
@@ -0,0 +1,198 @@
+#include "VertexIdTable.h"
+#include "picojson.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+const uint32_t VertexIdTable::NOT_FOUND;
+const VertexIdTable::Key VertexIdTable::STRING_TAG;
+const VertexIdTable::Key VertexIdTable::EMPTY_SLOT;
+
+namespace {
+  //Ids up to 15 digits are always exactly representable as a double.
+  const size_t MAX_NUMERIC_DIGITS = 15;
+  const double MAX_NUMERIC_ID = 1e15;
+
+  //A dense table is used when it would be at most this many times larger
+  //than the number of vertices.
+  const uint64_t MAX_DENSE_SPREAD = 4;
+}
+
+VertexIdTable::Key VertexIdTable::KeyFromString(const char* id, size_t length) {
+  const bool canonical = length > 0 && length <= MAX_NUMERIC_DIGITS &&
+    (id[0] != '0' || length == 1) &&
+    std::all_of(id, id + length, [](char c) { return c >= '0' && c <= '9'; });
+
+  if(canonical) {
+    Key key = 0;
+    for(size_t i = 0; i < length; ++i)
+      key = key * 10 + Key(id[i] - '0');
+    return key;
+  }
+
+  if((m_strings.size() + 1) * 2 > m_stringSlots.size())
+    GrowStrings();
+
+  const size_t mask = m_stringSlots.size() - 1;
+  size_t i = Hash(id, length) & mask;
+  for(; m_stringSlots[i] != NOT_FOUND; i = (i + 1) & mask) {
+    const auto& interned = m_strings[m_stringSlots[i]];
+    if(interned.length == length && std::equal(id, id + length, interned.text))
+      return STRING_TAG | Key(m_stringSlots[i]);
+  }
+
+  char* text = static_cast<char*>(m_stringArena.Allocate(length, 1));
+  std::copy(id, id + length, text);
+
+  m_stringSlots[i] = static_cast<uint32_t>(m_strings.size());
+  m_strings.push_back({ text, length });
+  return STRING_TAG | Key(m_strings.size() - 1);
+}
+
+VertexIdTable::Key VertexIdTable::KeyFromInteger(uint64_t id) {
+  if(id < static_cast<uint64_t>(MAX_NUMERIC_ID))
+    return id;
+
+  const std::string text = std::to_string(id);
+  return KeyFromString(text.data(), text.size());
+}
+
+VertexIdTable::Key VertexIdTable::KeyFromNumber(double id) {
+  if(id >= 0 && id < MAX_NUMERIC_ID && id == static_cast<double>(static_cast<Key>(id)))
+    return static_cast<Key>(id);
+
+  //Spelled the way the key of the vertex object would have been.
+  return KeyFromString(picojson::value(id).to_str());
+}
+
+VertexIdTable::Key VertexIdTable::ImportKey(const VertexIdTable& other, Key key) {
+  if(!(key & STRING_TAG))
+    return key;
+
+  const auto& interned = other.m_strings[key & ~STRING_TAG];
+  return KeyFromString(interned.text, interned.length);
+}
+
+size_t VertexIdTable::Hash(Key key) {
+  //splitmix64 finalizer; sequential ids would otherwise cluster.
+  key ^= key >> 30;
+  key *= 0xbf58476d1ce4e5b9ull;
+  key ^= key >> 27;
+  key *= 0x94d049bb133111ebull;
+  key ^= key >> 31;
+  return static_cast<size_t>(key);
+}
+
+size_t VertexIdTable::Hash(const char* text, size_t length) {
+  //FNV-1a
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for(size_t i = 0; i < length; ++i) {
+    hash ^= static_cast<unsigned char>(text[i]);
+    hash *= 0x100000001b3ull;
+  }
+  return static_cast<size_t>(hash);
+}
+
+void VertexIdTable::GrowStrings() {
+  m_stringSlots.assign(m_stringSlots.empty() ? 64 : m_stringSlots.size() * 2, NOT_FOUND);
+
+  const size_t mask = m_stringSlots.size() - 1;
+  for(uint32_t s = 0; s < m_strings.size(); ++s) {
+    size_t i = Hash(m_strings[s].text, m_strings[s].length) & mask;
+    while(m_stringSlots[i] != NOT_FOUND)
+      i = (i + 1) & mask;
+    m_stringSlots[i] = s;
+  }
+}
+
+void VertexIdTable::Grow() {
+  std::vector<Slot> old;
+  old.swap(m_slots);
+  m_slots.assign(old.empty() ? 64 : old.size() * 2, { EMPTY_SLOT, NOT_FOUND });
+
+  const size_t mask = m_slots.size() - 1;
+  for(const auto& slot : old) {
+    if(slot.key == EMPTY_SLOT)
+      continue;
+    size_t i = Hash(slot.key) & mask;
+    while(m_slots[i].key != EMPTY_SLOT)
+      i = (i + 1) & mask;
+    m_slots[i] = slot;
+  }
+}
+
+void VertexIdTable::Define(Key key, uint32_t index) {
+  if((m_count + 1) * 2 > m_slots.size())
+    Grow();
+
+  const size_t mask = m_slots.size() - 1;
+  size_t i = Hash(key) & mask;
+  while(m_slots[i].key != EMPTY_SLOT && m_slots[i].key != key)
+    i = (i + 1) & mask;
+
+  if(m_slots[i].key == EMPTY_SLOT) {
+    m_slots[i].key = key;
+    ++m_count;
+  }
+  m_slots[i].index = index;
+
+  m_allNumeric = m_allNumeric && !(key & STRING_TAG);
+  m_minKey = std::min(m_minKey, key);
+  m_maxKey = std::max(m_maxKey, key);
+}
+
+void VertexIdTable::Finalize() {
+  m_dense.clear();
+  if(m_count == 0 || !m_allNumeric || m_maxKey - m_minKey >= m_count * MAX_DENSE_SPREAD)
+    return;
+
+  m_dense.assign(m_maxKey - m_minKey + 1, NOT_FOUND);
+  for(const auto& slot : m_slots) {
+    if(slot.key != EMPTY_SLOT)
+      m_dense[slot.key - m_minKey] = slot.index;
+  }
+}
+
+uint32_t VertexIdTable::Find(Key key) const {
+  if(!m_dense.empty()) {
+    const Key offset = key - m_minKey;
+    return (key >= m_minKey && offset < m_dense.size()) ? m_dense[offset] : NOT_FOUND;
+  }
+
+  if(m_slots.empty())
+    return NOT_FOUND;
+
+  const size_t mask = m_slots.size() - 1;
+  for(size_t i = Hash(key) & mask; m_slots[i].key != EMPTY_SLOT; i = (i + 1) & mask) {
+    if(m_slots[i].key == key)
+      return m_slots[i].index;
+  }
+  return NOT_FOUND;
+}
+
+uint32_t VertexIdTable::Resolve(Key key) const {
+  const auto index = Find(key);
+  if(index == NOT_FOUND)
+    throw std::runtime_error("Error parsing json: Edge references unknown vertex " + KeyToString(key));
+  return index;
+}
+
+std::string VertexIdTable::KeyToString(Key key) const {
+  if(key & STRING_TAG) {
+    const auto& interned = m_strings[key & ~STRING_TAG];
+    return std::string(interned.text, interned.length);
+  }
+  return std::to_string(key);
+}
+
+void VertexIdTable::Clear() {
+  m_stringArena.Reset();
+  m_strings.clear();
+  std::fill(m_stringSlots.begin(), m_stringSlots.end(), NOT_FOUND);
+  std::fill(m_slots.begin(), m_slots.end(), Slot{ EMPTY_SLOT, NOT_FOUND });
+  m_count = 0;
+  m_allNumeric = true;
+  m_minKey = EMPTY_SLOT;
+  m_maxKey = 0;
+  m_dense.clear();
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Arena.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//Maps the vertex ids used in path documents to vertex indices.
+//
+//Ids are turned into 64 bit keys as they are read. Canonical non-negative
+//integers - the only kind our exporters write - become their own value, so
+//numeric ids never allocate or round-trip through to_str(). Anything else
+//is interned into a side table and keyed by its position there, tagged
+//with the top bit. Interned text lives in an arena, so neither kind of id
+//costs a heap allocation per vertex.
+//
+//Lookups go through an open-addressing hash on the key, or, when every id
+//is numeric and they span a compact range, a dense table indexed directly
+//by id. Unlike unordered_map::operator[], unknown ids are reported.
+class VertexIdTable {
+public:
+  typedef uint64_t Key;
+  static const uint32_t NOT_FOUND = UINT32_MAX;
+
+  Key KeyFromString(const char* id, size_t length);
+  Key KeyFromString(const std::string& id) { return KeyFromString(id.data(), id.size()); }
+  Key KeyFromInteger(uint64_t id);
+  Key KeyFromNumber(double id);
+
+  //The key in this table for a key made by other, interning its text if needed.
+  Key ImportKey(const VertexIdTable& other, Key key);
+
+  //Binds key to a vertex index; later definitions of the same id win.
+  void Define(Key key, uint32_t index);
+
+  //Picks the lookup representation. Call once every vertex is defined.
+  void Finalize();
+
+  uint32_t Find(Key key) const;
+
+  //Returns key's index, throwing a runtime_error naming the id if it was never defined.
+  uint32_t Resolve(Key key) const;
+
+  std::string KeyToString(Key key) const;
+
+  //Forgets every id but keeps the allocated tables for reuse.
+  void Clear();
+
+private:
+  static const Key STRING_TAG = Key(1) << 63;
+  static const Key EMPTY_SLOT = ~Key(0);
+
+  struct Slot {
+    Key key;
+    uint32_t index;
+  };
+
+  struct InternedString {
+    const char* text;
+    size_t length;
+  };
+
+  static size_t Hash(Key key);
+  static size_t Hash(const char* text, size_t length);
+  void Grow();
+  void GrowStrings();
+
+  MonotonicArena m_stringArena;
+  std::vector<InternedString> m_strings; //by key without the tag
+  std::vector<uint32_t> m_stringSlots; //open addressing into m_strings, power of two sized
+
+  std::vector<Slot> m_slots; //power of two sized, at most half full
+  size_t m_count = 0;
+  bool m_allNumeric = true;
+  Key m_minKey = EMPTY_SLOT;
+  Key m_maxKey = 0;
+
+  std::vector<uint32_t> m_dense; //indexed by key - m_minKey, when compact
+};
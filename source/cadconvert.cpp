@@ -0,0 +1,46 @@
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include "JsonSerialization.h"
+#include "MappedFile.h"
+#include "PathBinary.h"
+#include "PathLoader.h"
+
+void PrintUsage() {
+  std::cout << "Invalid arguments." << std::endl;
+  std::cout << "Usage: cadconvert <input> <output>" << std::endl;
+  std::cout << "Converts a json path document to the binary path format, or a binary path back to json." << std::endl;
+}
+
+int main(int argc, char** argv) {
+  if(argc != 3) {
+    PrintUsage();
+    return 1;
+  }
+
+  try {
+    bool toJson;
+    {
+      MappedFile input(argv[1]);
+      toJson = IsBinaryPath(input.Data(), input.Size());
+    }
+
+    const auto path = LoadIndexedPathFile(argv[1]);
+
+    std::ofstream output(argv[2], toJson ? std::ios::out : std::ios::out | std::ios::binary);
+    if(!output)
+      throw std::runtime_error(std::string("Error opening output file ") + argv[2]);
+
+    if(toJson)
+      WritePathJson(path, output);
+    else
+      WriteBinaryPath(path, output);
+  }
+  catch(const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 2;
+  }
+
+  return 0;
+}
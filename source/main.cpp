@@ -2,48 +2,260 @@
 #include <fstream>
 #include <iomanip>
 #include <limits>
+#include <cstdlib>
+#include <string>
+#include <memory>
+#include <sstream>
+#include <algorithm>
+#include <vector>
+#include <thread>
 
 #define _USE_MATH_DEFINES
 #include <cmath>
 
 #include "picojson.h"
 #include "MachineInfo.h"
+#include "Nesting.h"
+#include "OrientedBounds.h"
+#include "PathValidation.h"
 #include "Vector2.h"
 #include "ToolPath.h"
-#include "JsonSerialization.h"
+#include "PathLoader.h"
+#include "Profile.h"
+#include "Quote.h"
+#include "Batch.h"
+#include "QuoteCache.h"
+#include "Server.h"
+#include "ThreadPool.h"
+#include "ToolingCatalog.h"
 
 void PrintUsage() {
   std::cout << "Invalid arguments. Json Data required" << std::endl;
+  std::cout << "Usage: cadquote <pathfile.json> [-j N]" << std::endl;
+  std::cout << "       cadquote --batch <dir|list-file> [-j N] [--format csv|jsonl]" << std::endl;
+  std::cout << "       cadquote --serve [--socket <path>] [-j N]" << std::endl;
+  std::cout << "Caching: [--cache-size <entries>] [--cache-dir <dir>]" << std::endl;
+  std::cout << "Quote tables: [--catalog <tooling.json>]" << std::endl;
+  std::cout << "Batch nesting: [--sheet <width>x<height>] [--rotate]" << std::endl;
+  std::cout << "Phase timing: [--profile] (single file and batch)" << std::endl;
+  std::cout << "Approximate arc trig: [--fast-math-geometry]" << std::endl;
+  std::cout << "Charge rotated stock: [--oriented-bounds]" << std::endl;
+  std::cout << "Reject crossing edges: [--validate-geometry]" << std::endl;
 }
 
-const static MachineInfo LASER_CUT_ALUMINUM = {.1, .5, 0.07, 0.75};
+const static MachineInfo LASER_CUT_ALUMINUM = {.1, .5, 0.07, 0.75, 4, 0, 0};
 
-void ProduceQuote(const MachineInfo& tooling, const ToolPath& path) {
+void ProduceQuote(const MachineInfo& tooling, const ToolingCatalog* catalog,
+                  const std::string& filename, unsigned threads, QuoteCache* cache) {
   
-  const auto cutTime = path.ComputeTravelHeuristic() / tooling.max_speed;
-  std::cout << "Estimated cut time: " << cutTime << " seconds" << std::endl;
+  //Only very large documents are actually split across the pool.
+  std::unique_ptr<ThreadPool> pool;
+  if(threads > 1)
+    pool.reset(new ThreadPool(threads));
+
+  QuoteBuffers buffers;
+  buffers.pool = pool.get();
+
+  if(catalog) {
+    std::vector<Quote> quotes;
+    QuoteFile(*catalog, filename, buffers, cache, quotes);
+
+    size_t nameWidth = 8;
+    for(const auto& name : catalog->names)
+      nameWidth = std::max(nameWidth, name.size() + 2);
+
+    std::cout << std::left << std::setw(static_cast<int>(nameWidth)) << "Machine"
+              << std::setw(18) << "Cut time (s)" << "Cost" << std::endl;
+    for(size_t i = 0; i < quotes.size(); ++i) {
+      std::ostringstream cutTime;
+      cutTime << quotes[i].cutTime;
+      std::cout << std::setw(static_cast<int>(nameWidth)) << catalog->names[i]
+                << std::setw(18) << cutTime.str()
+                << "$" << std::fixed << std::setprecision(2) << quotes[i].cost << std::endl;
+    }
+    return;
+  }
+  const auto quote = QuoteFile(tooling, filename, buffers, cache);
+  std::cout << "Estimated cut time: " << quote.cutTime << " seconds" << std::endl;
   
   std::cout << "Estimated cost: $" <<
     std::fixed << std::setprecision(2) <<
-    ComputeCost(tooling, path.ComputeBounds(), cutTime) << std::endl;
+    quote.cost << std::endl;
   }
 
+//The profile goes to stderr, like the batch summaries, so the quote output is unchanged.
+void PrintProfile(bool profile) {
+#if CADQUOTE_PROFILE
+  if(profile)
+    std::cerr << "Profile: " << ProfileJson() << std::endl;
+#else
+  (void)profile;
+#endif
+}
+
 int main(int argc, char** argv) {
-  if(argc != 2) {
+  std::string pathArg;
+  bool batch = false;
+  bool serve = false;
+  unsigned threads = std::thread::hardware_concurrency();
+  size_t cacheSize = 4096;
+  std::string cacheDir;
+  std::string catalogFile;
+  BatchOptions batchOptions = { "", 0, BatchFormat::Csv, nullptr, nullptr, nullptr };
+  NestOptions nestOptions = { { 0, 0 }, false };
+  bool nest = false;
+  bool profile = false;
+  ServeOptions serveOptions = { "", 0, nullptr, nullptr };
+
+  for(int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+
+    if(arg == "--batch" && hasValue) {
+      batch = true;
+      batchOptions.source = argv[++i];
+    }
+    else if(arg == "--serve") {
+      serve = true;
+    }
+    else if(arg == "--socket" && hasValue) {
+      serveOptions.socketPath = argv[++i];
+    }
+    else if(arg == "--cache-size" && hasValue) {
+      cacheSize = static_cast<size_t>(std::max(0, atoi(argv[++i])));
+    }
+    else if(arg == "--cache-dir" && hasValue) {
+      cacheDir = argv[++i];
+    }
+    else if(arg == "--sheet" && hasValue) {
+      char separator = 0;
+      std::istringstream size(argv[++i]);
+      size >> nestOptions.sheet.x >> separator >> nestOptions.sheet.y;
+      if(!size || separator != 'x' || !(nestOptions.sheet.x > 0 && nestOptions.sheet.y > 0)) {
+        PrintUsage();
+        return 1;
+      }
+      nest = true;
+    }
+    else if(arg == "--profile") {
+      profile = true;
+    }
+    else if(arg == "--fast-math-geometry") {
+      SetFastArcMath(true);
+    }
+    else if(arg == "--oriented-bounds") {
+      SetOrientedPricing(true);
+    }
+    else if(arg == "--validate-geometry") {
+      SetGeometryValidation(true);
+    }
+    else if(arg == "--rotate") {
+      nestOptions.allowRotation = true;
+    }
+    else if(arg == "--catalog" && hasValue) {
+      catalogFile = argv[++i];
+    }
+    else if(arg == "-j" && hasValue) {
+      threads = std::max(1, atoi(argv[++i]));
+    }
+    else if(arg == "--format" && hasValue) {
+      const std::string format = argv[++i];
+      if(format == "csv")
+        batchOptions.format = BatchFormat::Csv;
+      else if(format == "jsonl")
+        batchOptions.format = BatchFormat::JsonLines;
+      else {
+        PrintUsage();
+        return 1;
+      }
+    }
+    else if(pathArg.empty() && arg[0] != '-') {
+      pathArg = arg;
+    }
+    else {
+      PrintUsage();
+      return 1;
+    }
+  }
+
+  if(profile) {
+#if CADQUOTE_PROFILE
+    EnableProfiling();
+#else
+    std::cerr << "--profile is unavailable: cadquote was built without CADQUOTE_PROFILE" << std::endl;
+    return 1;
+#endif
+  }
+
+  std::unique_ptr<ToolingCatalog> catalog;
+  if(!catalogFile.empty()) {
+    try {
+      catalog.reset(new ToolingCatalog(LoadToolingCatalog(catalogFile)));
+    }
+    catch(const std::exception& e) {
+      std::cerr << e.what() << std::endl;
+      return 1;
+    }
+  }
+
+  if(batch || serve) {
+    if(!pathArg.empty() || (batch && serve) || (nest && (serve || catalog)) || (serve && profile)) {
+      PrintUsage();
+      return 1;
+    }
+
+    std::unique_ptr<QuoteCache> cache;
+    if(cacheSize > 0 || !cacheDir.empty())
+      cache.reset(new QuoteCache(cacheSize, cacheDir));
+
+    if(serve) {
+      serveOptions.threads = threads;
+      serveOptions.cache = cache.get();
+      serveOptions.catalog = catalog.get();
+      try {
+        return RunServer(LASER_CUT_ALUMINUM, serveOptions);
+      }
+      catch(const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+      }
+    }
+
+    batchOptions.threads = threads;
+    batchOptions.cache = cache.get();
+    batchOptions.catalog = catalog.get();
+    batchOptions.nest = nest ? &nestOptions : nullptr;
+    size_t failures = 0;
+    try {
+      failures = RunBatch(LASER_CUT_ALUMINUM, batchOptions, std::cout, std::cerr);
+    }
+    catch(const std::exception& e) {
+      std::cerr << e.what() << std::endl;
+      return 1;
+    }
+    if(cache)
+      std::cerr << "Quote cache: " << QuoteCacheStatsJson(cache->GetStats()) << std::endl;
+    PrintProfile(profile);
+    return failures == 0 ? 0 : 2;
+  }
+
+  if(pathArg.empty() || nest) {
     PrintUsage();
     return 1;
   }
   
-  std::ifstream pathFile(argv[1]);
-  if( pathFile.bad() ) {
-    throw std::runtime_error("Error opening path file." );
+  //A single quote only benefits from the persistent tier.
+  std::unique_ptr<QuoteCache> cache;
+  if(!cacheDir.empty())
+    cache.reset(new QuoteCache(0, cacheDir));
+
+  try {
+    ProduceQuote(LASER_CUT_ALUMINUM, catalog.get(), pathArg, threads, cache.get());
   }
-  
-  picojson::value v;
-  pathFile >> v;
-  
-  ToolPath path(std::move(v));
-  
-  ProduceQuote(LASER_CUT_ALUMINUM, path);
+  catch(const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 2;
+  }
+  PrintProfile(profile);
   return 0;
 }
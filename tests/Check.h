@@ -0,0 +1,30 @@
+#pragma once
+
+#include <iostream>
+
+//Minimal assertions for the test programs. A failed CHECK reports its line
+//and the test carries on; main returns TestResult().
+
+namespace TestDetail {
+inline int& Failures() {
+  static int failures = 0;
+  return failures;
+}
+}
+
+#define CHECK(condition) \
+  do { \
+    if(!(condition)) { \
+      std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #condition ") failed" << std::endl; \
+      ++TestDetail::Failures(); \
+    } \
+  } while(0)
+
+//Exit code for main: 0 when every check passed.
+inline int TestResult() {
+  if(TestDetail::Failures() > 0) {
+    std::cerr << TestDetail::Failures() << " checks failed" << std::endl;
+    return 1;
+  }
+  return 0;
+}
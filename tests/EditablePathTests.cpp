@@ -0,0 +1,203 @@
+#include "Check.h"
+#include "EditablePath.h"
+#include "ToolPath.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+//Checks that EditablePath's running travel and bounds agree with
+//evaluating the path afresh after every kind of edit.
+
+namespace {
+
+struct EdgeRecord {
+  EditablePath::EdgeId id;
+  EditablePath::VertexId v0, v1;
+  bool arc;
+};
+
+//Travel may differ by the order of its additions; bounds are exact.
+void CheckAgrees(const EditablePath& editable) {
+  const auto fresh = MakeToolPath(editable.ToIndexedPath()).Evaluate();
+  CHECK(std::abs(editable.Travel() - fresh.travel) <= 1e-9 * std::max(1.0, fresh.travel));
+  CHECK(editable.Bounds().x == fresh.Bounds().x);
+  CHECK(editable.Bounds().y == fresh.Bounds().y);
+}
+
+template<typename T>
+T TakeRandom(std::vector<T>& items, std::mt19937& random) {
+  std::uniform_int_distribution<size_t> pick(0, items.size() - 1);
+  const size_t index = pick(random);
+  const T item = items[index];
+  items[index] = items.back();
+  items.pop_back();
+  return item;
+}
+
+void TestRandomEdits() {
+  //Two edges to start, so the tree grows many times over.
+  IndexedPath start;
+  start.vertices = { { 0, 0 }, { 1, 0 }, { 1, 1 } };
+  start.lines = { { 0, 1 } };
+  start.arcs = { { 1, 2, { 1, 0.5 } } };
+  EditablePath editable(start);
+  CheckAgrees(editable);
+
+  std::vector<EditablePath::VertexId> vertices = { 0, 1, 2 };
+  std::vector<EdgeRecord> edges = { { 0, 0, 1, false }, { 1, 1, 2, true } };
+
+  std::mt19937 random(19);
+  std::uniform_real_distribution<double> coordinate(-50, 50);
+  std::uniform_real_distribution<double> nudge(-1, 1);
+  std::uniform_int_distribution<int> operation(0, 99);
+  const auto randomVertex = [&] {
+    std::uniform_int_distribution<size_t> pick(0, vertices.size() - 1);
+    return vertices[pick(random)];
+  };
+
+  size_t reusedVertices = 0;
+  size_t reusedEdges = 0;
+  size_t mostEdges = 0;
+  std::vector<EditablePath::VertexId> freedVertices;
+  std::vector<EditablePath::EdgeId> freedEdges;
+
+  for(int step = 0; step < 20000; ++step) {
+    const int op = operation(random);
+    //Grows for the first half, then shrinks back towards empty.
+    const bool growing = step < 10000;
+
+    if(op < 20 || vertices.size() < 2) {
+      const auto vertex = editable.AddVertex({ coordinate(random), coordinate(random) });
+      const auto freed = std::find(freedVertices.begin(), freedVertices.end(), vertex);
+      CHECK(freedVertices.empty() || freed != freedVertices.end());
+      if(freed != freedVertices.end()) {
+        freedVertices.erase(freed);
+        ++reusedVertices;
+      }
+      vertices.push_back(vertex);
+    }
+    else if(op < 40) {
+      const auto vertex = randomVertex();
+      const auto& position = editable.Position(vertex);
+      editable.MoveVertex(vertex, { position.x + nudge(random), position.y + nudge(random) });
+    }
+    else if(op < (growing ? 45 : 55)) {
+      const auto vertex = TakeRandom(vertices, random);
+      editable.RemoveVertex(vertex);
+      freedVertices.push_back(vertex);
+      for(size_t i = 0; i < edges.size();) {
+        if(edges[i].v0 == vertex || edges[i].v1 == vertex) {
+          freedEdges.push_back(edges[i].id);
+          edges[i] = edges.back();
+          edges.pop_back();
+        }
+        else {
+          ++i;
+        }
+      }
+    }
+    else if(op < (growing ? 80 : 70)) {
+      const auto v0 = randomVertex();
+      const auto v1 = randomVertex();
+      const bool arc = op % 2 == 0 && v0 != v1;
+      EditablePath::EdgeId id;
+      if(arc) {
+        //Centered off the chord's midpoint, to either side.
+        const auto& a = editable.Position(v0);
+        const auto& b = editable.Position(v1);
+        const double bulge = nudge(random);
+        const Vector2 center = { (a.x + b.x) / 2 - bulge * (b.y - a.y), (a.y + b.y) / 2 + bulge * (b.x - a.x) };
+        id = editable.AddArc(v0, v1, center);
+      }
+      else {
+        id = editable.AddLine(v0, v1);
+      }
+      //A freed id is reused before the id range grows.
+      const auto freed = std::find(freedEdges.begin(), freedEdges.end(), id);
+      CHECK(freedEdges.empty() || freed != freedEdges.end());
+      if(freed != freedEdges.end()) {
+        freedEdges.erase(freed);
+        ++reusedEdges;
+      }
+      edges.push_back({ id, v0, v1, arc });
+    }
+    else if(op < 90) {
+      std::vector<EdgeRecord> arcs;
+      for(const auto& edge : edges)
+        if(edge.arc)
+          arcs.push_back(edge);
+      if(!arcs.empty()) {
+        const auto arc = TakeRandom(arcs, random);
+        const auto& a = editable.Position(arc.v0);
+        editable.MoveArcCenter(arc.id, { a.x + 2 * nudge(random), a.y + 2 * nudge(random) });
+      }
+    }
+    else if(!edges.empty()) {
+      const auto edge = TakeRandom(edges, random);
+      editable.RemoveEdge(edge.id);
+      freedEdges.push_back(edge.id);
+    }
+
+    CHECK(editable.VertexCount() == vertices.size());
+    CHECK(editable.EdgeCount() == edges.size());
+    mostEdges = std::max(mostEdges, edges.size());
+    CheckAgrees(editable);
+  }
+
+  CHECK(reusedVertices > 0);
+  CHECK(reusedEdges > 0);
+  CHECK(mostEdges > 1000);
+
+  //Removing everything leaves an empty path with no travel or extent.
+  while(!vertices.empty())
+    editable.RemoveVertex(TakeRandom(vertices, random));
+  CHECK(editable.EdgeCount() == 0);
+  CHECK(editable.Travel() == 0);
+  CheckAgrees(editable);
+}
+
+void TestRemovedIdsThrow() {
+  EditablePath editable;
+  const auto a = editable.AddVertex({ 0, 0 });
+  const auto b = editable.AddVertex({ 1, 0 });
+  const auto line = editable.AddLine(a, b);
+
+  bool threw = false;
+  try {
+    editable.MoveArcCenter(line, { 0, 0 });
+  }
+  catch(const std::runtime_error&) {
+    threw = true;
+  }
+  CHECK(threw);
+
+  editable.RemoveVertex(b);
+  CHECK(editable.EdgeCount() == 0);
+  threw = false;
+  try {
+    editable.RemoveEdge(line);
+  }
+  catch(const std::runtime_error&) {
+    threw = true;
+  }
+  CHECK(threw);
+  threw = false;
+  try {
+    editable.MoveVertex(b, { 2, 2 });
+  }
+  catch(const std::runtime_error&) {
+    threw = true;
+  }
+  CHECK(threw);
+}
+
+}
+
+int main() {
+  TestRandomEdits();
+  TestRemovedIdsThrow();
+  return TestResult();
+}
@@ -0,0 +1,130 @@
+#include "Check.h"
+#include "FastMath.h"
+#include "JsonSerialization.h"
+#include "MachineInfo.h"
+#include "PathGenerator.h"
+#include "Quote.h"
+#include "ToolPath.h"
+
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//Bounds what --fast-math-geometry does to quotes, and the approximations
+//themselves against libm at the maximum errors FastMath.h states.
+
+namespace {
+
+const MachineInfo LASER = {.1, .5, 0.07, 0.75, 4, 0, 0};
+
+//Relative difference the README allows between fast and default quotes.
+const double QUOTE_TOLERANCE = 1e-15;
+
+double RelativeError(double approximate, double reference) {
+  return std::abs(approximate - reference) / std::max(std::abs(reference), 1e-300);
+}
+
+Quote QuoteWith(bool fast, const std::string& document) {
+  SetFastArcMath(fast);
+  QuoteBuffers buffers;
+  const auto quote = QuoteDocument(LASER, document.data(), document.size(), buffers, nullptr);
+  SetFastArcMath(false);
+  return quote;
+}
+
+void CheckSameQuote(const std::string& document) {
+  const auto exact = QuoteWith(false, document);
+  const auto fast = QuoteWith(true, document);
+  CHECK(RelativeError(fast.cutTime, exact.cutTime) <= QUOTE_TOLERANCE);
+  CHECK(RelativeError(fast.cost, exact.cost) <= QUOTE_TOLERANCE);
+  CHECK(std::round(fast.cost * 100) == std::round(exact.cost * 100));
+}
+
+std::string ReadDocument(const std::string& filename) {
+  std::ifstream in(filename, std::ios::binary);
+  std::ostringstream contents;
+  contents << in.rdbuf();
+  CHECK(in.good() || in.eof());
+  return contents.str();
+}
+
+void TestSampleQuotes() {
+  for(const char* name : { "CutCircularArc.json", "ExtrudeCircularArc.json", "Rectangle.json" })
+    CheckSameQuote(ReadDocument(std::string(CADQUOTE_DATA_DIR) + "/" + name));
+}
+
+void TestGeneratedQuotes() {
+  for(auto shape : { PathShape::Gear, PathShape::Contours }) {
+    std::ostringstream json;
+    WritePathJson(GeneratePath(shape, 100000), json);
+    CheckSameQuote(json.str());
+  }
+}
+
+void TestAcos() {
+  std::mt19937 random(1);
+  std::uniform_real_distribution<double> argument(-1, 1);
+  double worst = 0;
+  for(int i = 0; i < 1000000; ++i) {
+    const double x = argument(random);
+    worst = std::max(worst, std::abs(FastAcos(x) - std::acos(x)));
+  }
+  for(double x : { -1.0, -0.5, 0.0, 0.5, 1.0 })
+    worst = std::max(worst, std::abs(FastAcos(x) - std::acos(x)));
+  CHECK(worst <= 4.5e-16);
+
+  //Just outside the domain, as a rounded dot product can be.
+  CHECK(FastAcos(std::nextafter(1.0, 2.0)) == 0);
+  CHECK(FastAcos(std::nextafter(-1.0, -2.0)) == M_PI);
+}
+
+void TestAtan2() {
+  std::mt19937 random(2);
+  std::uniform_real_distribution<double> angle(-M_PI, M_PI);
+  std::uniform_real_distribution<double> exponent(-20, 20);
+  double worst = 0;
+  for(int i = 0; i < 1000000; ++i) {
+    const double r = std::pow(10.0, exponent(random));
+    const double a = angle(random);
+    const double y = r * std::sin(a);
+    const double x = r * std::cos(a);
+    worst = std::max(worst, std::abs(FastAtan2(y, x) - std::atan2(y, x)));
+  }
+  CHECK(worst <= 4.5e-16);
+
+  for(double y : { 0.0, -0.0 })
+    for(double x : { 0.0, -0.0, 1.0, -1.0 })
+      CHECK(FastAtan2(y, x) == std::atan2(y, x) && std::signbit(FastAtan2(y, x)) == std::signbit(std::atan2(y, x)));
+}
+
+void TestExp() {
+  std::mt19937 random(3);
+  std::uniform_real_distribution<double> argument(-700, 709);
+  std::uniform_real_distribution<double> small(-2, 2);
+  double worst = 0;
+  for(int i = 0; i < 1000000; ++i) {
+    const double x = i % 2 == 0 ? argument(random) : small(random);
+    worst = std::max(worst, RelativeError(FastExp(x), std::exp(x)));
+  }
+  CHECK(worst <= 4.8e-16);
+
+  CHECK(FastExp(0) == 1);
+  CHECK(FastExp(800) == std::numeric_limits<double>::infinity());
+  CHECK(FastExp(-800) == 0);
+  CHECK(std::isnan(FastExp(std::numeric_limits<double>::quiet_NaN())));
+}
+
+}
+
+int main() {
+  TestSampleQuotes();
+  TestGeneratedQuotes();
+  TestAcos();
+  TestAtan2();
+  TestExp();
+  return TestResult();
+}
@@ -0,0 +1,93 @@
+#include "Check.h"
+#include "MotionPlanner.h"
+
+#include <cmath>
+#include <limits>
+
+//Checks the trapezoidal planner against closed form move times.
+
+namespace {
+
+const double INFINITE = std::numeric_limits<double>::infinity();
+
+bool Near(double a, double b) {
+  return std::abs(a - b) <= 1e-12 * std::max(1.0, std::abs(b));
+}
+
+void AddMove(CutSequence& cuts, double length, double radius, double junction) {
+  cuts.length.push_back(length);
+  cuts.radius.push_back(radius);
+  cuts.junction.push_back(junction);
+}
+
+//Too short to reach full speed: accelerate over half, brake over the rest,
+//2 sqrt(L / a).
+void TestTriangularLine() {
+  CutSequence cuts;
+  AddMove(cuts, 1, INFINITE, 0);
+  CHECK(Near(ComputeKinematicTime(cuts, 10, 4, 0.002), 1));
+}
+
+//Reaches full speed v: v / a to accelerate and again to brake, covering
+//v^2 / a between them, and the rest at v.
+void TestTrapezoidalLine() {
+  CutSequence cuts;
+  AddMove(cuts, 10, INFINITE, 0);
+  CHECK(Near(ComputeKinematicTime(cuts, 1, 1, 0.002), 1 + 9 + 1));
+}
+
+//Straight on, the junction doesn't slow the head: two halves take as long
+//as the whole line.
+void TestStraightJunction() {
+  CutSequence cuts;
+  AddMove(cuts, 5, INFINITE, 0);
+  AddMove(cuts, 5, INFINITE, INFINITE);
+  CHECK(Near(ComputeKinematicTime(cuts, 1, 1, 0.002), 11));
+}
+
+//A reversal stops the head, so each half is its own rest to rest move.
+void TestReversal() {
+  CutSequence cuts;
+  AddMove(cuts, 5, INFINITE, 0);
+  AddMove(cuts, 5, INFINITE, 0);
+  CHECK(Near(ComputeKinematicTime(cuts, 1, 1, 0.002), 2 * (1 + 4 + 1)));
+}
+
+//An arc is cut no faster than sqrt(a r), whatever the max speed.
+void TestArcSpeedLimit() {
+  //r = 1/4 and a = 4 cap the speed at 1: 1/4 s and 1/8 in at each end.
+  CutSequence arc;
+  AddMove(arc, 10, 0.25, 0);
+  CHECK(Near(ComputeKinematicTime(arc, 10, 4, 0.002), 0.25 + 9.75 + 0.25));
+
+  //A line at 2 in/s into a tangent arc brakes to the arc's 1 in/s before
+  //the joint: line 0.5 s up, 0.25 s down over 0.375 in, 9.125 in at 2;
+  //arc 9.875 in at 1 and 0.25 s to stop.
+  CutSequence cuts;
+  AddMove(cuts, 10, INFINITE, 0);
+  AddMove(cuts, 10, 0.25, INFINITE);
+  CHECK(Near(ComputeKinematicTime(cuts, 2, 4, 0.002), (0.5 + 0.25 + 9.125 / 2) + (9.875 + 0.25)));
+}
+
+//A corner's speed is set by the junction deviation rule, v^2 = a d factor.
+void TestCornerSpeed() {
+  //a = 4, d = 1/2 and factor 1/2 allow 1 in/s at the corner. From rest,
+  //4 in/s^2 reaches 1 in/s in 1/4 s over exactly 1/8 in, so each leg is a
+  //single 1/4 s ramp: up to the corner speed, then back down.
+  CutSequence cuts;
+  AddMove(cuts, 0.125, INFINITE, 0);
+  AddMove(cuts, 0.125, INFINITE, 0.5);
+  CHECK(Near(ComputeKinematicTime(cuts, 10, 4, 0.5), 0.5));
+}
+
+}
+
+int main() {
+  TestTriangularLine();
+  TestTrapezoidalLine();
+  TestStraightJunction();
+  TestReversal();
+  TestArcSpeedLimit();
+  TestCornerSpeed();
+  return TestResult();
+}
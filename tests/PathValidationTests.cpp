@@ -0,0 +1,203 @@
+#include "Check.h"
+#include "PathValidation.h"
+#include "ThreadPool.h"
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+//Checks that crossing, touching and overlapping edges are reported by id,
+//and that edges meeting only at shared endpoints are not.
+
+namespace {
+
+struct PathBuilder {
+  IndexedPath path;
+
+  uint32_t Vertex(double x, double y) {
+    path.vertices.push_back({ x, y });
+    return static_cast<uint32_t>(path.vertices.size() - 1);
+  }
+  void Line(uint32_t v0, uint32_t v1) { path.lines.push_back({ v0, v1 }); }
+  //v0 is first moving counter-clockwise around center.
+  void Arc(uint32_t v0, uint32_t v1, Vector2 center) { path.arcs.push_back({ v0, v1, center }); }
+};
+
+//The error ValidatePathGeometry throws, or an empty string if it passes.
+std::string ValidationError(const IndexedPath& path) {
+  try {
+    ValidatePathGeometry(path, nullptr);
+  }
+  catch(const std::runtime_error& e) {
+    return e.what();
+  }
+  return std::string();
+}
+
+//Reports the same edges serially and across a pool.
+void CheckReported(const IndexedPath& path, const std::vector<uint32_t>& expected, const std::string& message) {
+  static ThreadPool pool(2);
+  CHECK(FindIntersectingEdges(path, nullptr) == expected);
+  CHECK(FindIntersectingEdges(path, &pool) == expected);
+  CHECK(ValidationError(path) == message);
+}
+
+void CheckPasses(const IndexedPath& path) {
+  CheckReported(path, {}, "");
+}
+
+void TestLineCrossing() {
+  PathBuilder x;
+  x.Line(x.Vertex(0, 0), x.Vertex(2, 2));
+  x.Line(x.Vertex(0, 2), x.Vertex(2, 0));
+  CheckReported(x.path, { 0, 1 }, "Path has 2 intersecting edges: line 0, line 1");
+
+  //An L sharing its corner vertex is fine.
+  PathBuilder corner;
+  const uint32_t v = corner.Vertex(0, 0);
+  corner.Line(v, corner.Vertex(2, 0));
+  corner.Line(v, corner.Vertex(0, 2));
+  CheckPasses(corner.path);
+}
+
+void TestTJunction() {
+  //The stem ends on the bar without sharing a vertex with it; an untouched
+  //line alongside isn't reported.
+  PathBuilder t;
+  t.Line(t.Vertex(0, 5), t.Vertex(2, 5));
+  t.Line(t.Vertex(0, 0), t.Vertex(2, 0));
+  t.Line(t.Vertex(1, 0), t.Vertex(1, 1));
+  CheckReported(t.path, { 1, 2 }, "Path has 2 intersecting edges: line 1, line 2");
+}
+
+void TestCollinearOverlap() {
+  PathBuilder overlap;
+  overlap.Line(overlap.Vertex(0, 0), overlap.Vertex(2, 0));
+  overlap.Line(overlap.Vertex(1, 0), overlap.Vertex(3, 0));
+  CheckReported(overlap.path, { 0, 1 }, "Path has 2 intersecting edges: line 0, line 1");
+
+  //Doubling back along a line from a shared vertex overlaps it too.
+  PathBuilder back;
+  const uint32_t v = back.Vertex(2, 0);
+  back.Line(back.Vertex(0, 0), v);
+  back.Line(v, back.Vertex(1, 0));
+  CheckReported(back.path, { 0, 1 }, "Path has 2 intersecting edges: line 0, line 1");
+
+  //Continuing straight on from a shared vertex does not.
+  PathBuilder straight;
+  const uint32_t mid = straight.Vertex(1, 0);
+  straight.Line(straight.Vertex(0, 0), mid);
+  straight.Line(mid, straight.Vertex(2, 0));
+  CheckPasses(straight.path);
+}
+
+void TestDuplicatedLine() {
+  PathBuilder duplicate;
+  const uint32_t a = duplicate.Vertex(0, 0);
+  const uint32_t b = duplicate.Vertex(3, 1);
+  duplicate.Line(a, b);
+  duplicate.Line(b, duplicate.Vertex(3, 4));
+  duplicate.Line(a, b);
+  CheckReported(duplicate.path, { 0, 2 }, "Path has 2 intersecting edges: line 0, line 2");
+}
+
+void TestLineAndArc() {
+  //Upper half of the unit circle, crossed at (0, 1).
+  PathBuilder crossing;
+  crossing.Arc(crossing.Vertex(1, 0), crossing.Vertex(-1, 0), { 0, 0 });
+  crossing.Line(crossing.Vertex(0, -0.5), crossing.Vertex(0, 2));
+  CheckReported(crossing.path, { 0, 1 }, "Path has 2 intersecting edges: line 0, arc 0");
+
+  //A line grazing the top of the arc touches it.
+  PathBuilder grazing;
+  grazing.Arc(grazing.Vertex(1, 0), grazing.Vertex(-1, 0), { 0, 0 });
+  grazing.Line(grazing.Vertex(-2, 1), grazing.Vertex(2, 1));
+  CheckReported(grazing.path, { 0, 1 }, "Path has 2 intersecting edges: line 0, arc 0");
+
+  //A slot end: lines run into the arc tangentially at its shared endpoints.
+  PathBuilder slot;
+  const uint32_t right = slot.Vertex(1, 0);
+  const uint32_t left = slot.Vertex(-1, 0);
+  slot.Arc(right, left, { 0, 0 });
+  slot.Line(slot.Vertex(1, -3), right);
+  slot.Line(left, slot.Vertex(-1, -3));
+  CheckPasses(slot.path);
+
+  //A half disc: the diameter meets the arc at both its ends.
+  PathBuilder halfDisc;
+  const uint32_t a = halfDisc.Vertex(1, 0);
+  const uint32_t b = halfDisc.Vertex(-1, 0);
+  halfDisc.Arc(a, b, { 0, 0 });
+  halfDisc.Line(b, a);
+  CheckPasses(halfDisc.path);
+}
+
+void TestArcsCrossing() {
+  //Upper halves of unit circles about (0, 0) and (1, 0), crossing at
+  //(1/2, sqrt(3)/2).
+  PathBuilder arcs;
+  arcs.Arc(arcs.Vertex(1, 0), arcs.Vertex(-1, 0), { 0, 0 });
+  arcs.Arc(arcs.Vertex(2, 0), arcs.Vertex(0, 0), { 1, 0 });
+  CheckReported(arcs.path, { 0, 1 }, "Path has 2 intersecting edges: arc 0, arc 1");
+
+  //Lower halves of the same circles cross too; lines come first in the ids.
+  PathBuilder mixed;
+  mixed.Line(mixed.Vertex(10, 10), mixed.Vertex(11, 10));
+  mixed.Arc(mixed.Vertex(-1, 0), mixed.Vertex(1, 0), { 0, 0 });
+  mixed.Arc(mixed.Vertex(0, 0), mixed.Vertex(2, 0), { 1, 0 });
+  CheckReported(mixed.path, { 1, 2 }, "Path has 2 intersecting edges: arc 0, arc 1");
+
+  //The upper half of one and the lower half of the other miss.
+  PathBuilder apart;
+  apart.Arc(apart.Vertex(1, 0), apart.Vertex(-1, 0), { 0, 0 });
+  apart.Arc(apart.Vertex(0, 0), apart.Vertex(2, 0), { 1, 0 });
+  CheckPasses(apart.path);
+}
+
+void TestArcsOnOneCircle() {
+  //Quarter circle to half circle: overlapping between 90 and 180 degrees.
+  PathBuilder overlap;
+  overlap.Arc(overlap.Vertex(1, 0), overlap.Vertex(-1, 0), { 0, 0 });
+  overlap.Arc(overlap.Vertex(0, 1), overlap.Vertex(0, -1), { 0, 0 });
+  CheckReported(overlap.path, { 0, 1 }, "Path has 2 intersecting edges: arc 0, arc 1");
+
+  //A whole circle from two halves sharing both ends.
+  PathBuilder circle;
+  const uint32_t a = circle.Vertex(1, 0);
+  const uint32_t b = circle.Vertex(-1, 0);
+  circle.Arc(a, b, { 0, 0 });
+  circle.Arc(b, a, { 0, 0 });
+  CheckPasses(circle.path);
+}
+
+void TestReportLimit() {
+  //An 11 by 11 lattice of lines: every one crosses, and past 20 the rest
+  //are counted rather than named.
+  PathBuilder lattice;
+  for(int i = 0; i < 11; ++i) {
+    lattice.Line(lattice.Vertex(i, -1), lattice.Vertex(i, 11));
+    lattice.Line(lattice.Vertex(-1, i), lattice.Vertex(11, i));
+  }
+  std::vector<uint32_t> all(22);
+  for(uint32_t i = 0; i < all.size(); ++i)
+    all[i] = i;
+  std::string message = "Path has 22 intersecting edges: line 0";
+  for(int i = 1; i < 20; ++i)
+    message += ", line " + std::to_string(i);
+  CheckReported(lattice.path, all, message + " and 2 more");
+}
+
+}
+
+int main() {
+  TestLineCrossing();
+  TestTJunction();
+  TestCollinearOverlap();
+  TestDuplicatedLine();
+  TestLineAndArc();
+  TestArcsCrossing();
+  TestArcsOnOneCircle();
+  TestReportLimit();
+  return TestResult();
+}
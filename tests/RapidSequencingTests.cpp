@@ -0,0 +1,157 @@
+#include "Check.h"
+#include "JsonSerialization.h"
+#include "MachineInfo.h"
+#include "Quote.h"
+#include "RapidSequencing.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+//Checks that rapid sequencing, and the quotes that charge for it, depend
+//only on the part: the same path gets the same plan and the same cost, run
+//alone or next to other quotes.
+
+namespace {
+
+const MachineInfo LASER = {.1, .5, 0.07, 0.75, 4, 0, 0};
+const MachineInfo KINEMATIC_LASER = {.1, .5, 0.07, 0.75, 4, 20, 0.002};
+
+uint32_t AddVertex(IndexedPath& path, double x, double y) {
+  path.vertices.push_back({ x, y });
+  return static_cast<uint32_t>(path.vertices.size() - 1);
+}
+
+void AddSquare(IndexedPath& path, double x, double y, double size) {
+  const uint32_t v = AddVertex(path, x, y);
+  AddVertex(path, x + size, y);
+  AddVertex(path, x + size, y + size);
+  AddVertex(path, x, y + size);
+  for(uint32_t k = 0; k < 4; ++k)
+    path.lines.push_back({ v + k, v + (k + 1) % 4 });
+}
+
+//count small squares and open chains scattered at random, so nearest
+//neighbour leaves plenty for the improvement phase to do.
+IndexedPath ScatteredContours(size_t count, unsigned seed) {
+  std::mt19937 random(seed);
+  std::uniform_real_distribution<double> position(0, 10 * std::sqrt(double(count)));
+  IndexedPath path;
+  for(size_t i = 0; i < count; ++i) {
+    const double x = position(random);
+    const double y = position(random);
+    if(i % 3 == 0) {
+      const uint32_t v = AddVertex(path, x, y);
+      AddVertex(path, x + 0.5, y + 0.25);
+      AddVertex(path, x + 1, y);
+      path.lines.push_back({ v, v + 1 });
+      path.lines.push_back({ v + 1, v + 2 });
+    }
+    else {
+      AddSquare(path, x, y, 0.5);
+    }
+  }
+  return path;
+}
+
+bool SamePlan(const RapidPlan& a, const RapidPlan& b) {
+  return a.order == b.order && a.entry == b.entry && a.reversed == b.reversed &&
+         a.rapidDistance == b.rapidDistance && a.nearestNeighbourDistance == b.nearestNeighbourDistance;
+}
+
+void TestEmptyPath() {
+  IndexedPath path;
+  const auto topology = AnalyzeTopology(path);
+  const auto plan = PlanRapidMoves(path, topology, DefaultRapidOptions());
+  CHECK(plan.order.empty());
+  CHECK(plan.rapidDistance == 0);
+  CHECK(PlanRapidDistance(path) == 0);
+}
+
+void TestSingleContour() {
+  IndexedPath path;
+  AddSquare(path, 5, 5, 2);
+  const auto topology = AnalyzeTopology(path);
+  const auto plan = PlanRapidMoves(path, topology, DefaultRapidOptions());
+  CHECK(plan.order.size() == 1);
+  CHECK(plan.order[0] == 0);
+  CHECK(plan.rapidDistance == 0);
+  CHECK(plan.nearestNeighbourDistance == 0);
+  CHECK(PlanRapidDistance(path) == 0);
+}
+
+void TestTwoContours() {
+  IndexedPath path;
+  AddSquare(path, 0, 0, 1);
+  AddSquare(path, 4, 0, 1);
+  const auto topology = AnalyzeTopology(path);
+  const auto plan = PlanRapidMoves(path, topology, DefaultRapidOptions());
+  CHECK(plan.order.size() == 2);
+  //Closest corners are (1, 0) and (4, 0).
+  CHECK(plan.rapidDistance == 3);
+}
+
+void TestDeterministicAndNoWorseThanNearestNeighbour() {
+  const auto path = ScatteredContours(20000, 5);
+  const auto topology = AnalyzeTopology(path);
+  const auto first = PlanRapidMoves(path, topology, DefaultRapidOptions());
+  const auto second = PlanRapidMoves(path, topology, DefaultRapidOptions());
+  CHECK(SamePlan(first, second));
+  CHECK(first.rapidDistance <= first.nearestNeighbourDistance);
+  CHECK(first.rapidDistance < first.nearestNeighbourDistance);
+  CHECK(PlanRapidDistance(path) == first.rapidDistance);
+
+  std::vector<uint8_t> seen(topology.ContourCount(), 0);
+  for(uint32_t c : first.order)
+    seen[c]++;
+  for(uint8_t count : seen)
+    CHECK(count == 1);
+}
+
+void TestQuoteRepeatsUnderLoad(const MachineInfo& tooling) {
+  std::ostringstream json;
+  WritePathJson(ScatteredContours(25000, 9), json);
+  const std::string document = json.str();
+
+  const auto quote = [&] {
+    QuoteBuffers buffers;
+    return QuoteDocument(tooling, document.data(), document.size(), buffers, nullptr);
+  };
+
+  const Quote alone = quote();
+  const Quote again = quote();
+  CHECK(again.cost == alone.cost);
+  CHECK(again.cutTime == alone.cutTime);
+
+  //Twice as many quotes as cores, all at once.
+  const unsigned threadCount = 2 * std::max(2u, std::thread::hardware_concurrency());
+  std::vector<Quote> loaded(threadCount);
+  std::vector<std::thread> threads;
+  for(unsigned i = 0; i < threadCount; ++i)
+    threads.emplace_back([&, i] { loaded[i] = quote(); });
+  for(auto& thread : threads)
+    thread.join();
+  for(const auto& q : loaded) {
+    CHECK(q.cost == alone.cost);
+    CHECK(q.cutTime == alone.cutTime);
+  }
+}
+
+}
+
+int main() {
+  TestEmptyPath();
+  TestSingleContour();
+  TestTwoContours();
+  TestDeterministicAndNoWorseThanNearestNeighbour();
+  TestQuoteRepeatsUnderLoad(LASER);
+  TestQuoteRepeatsUnderLoad(KINEMATIC_LASER);
+
+  return TestResult();
+}